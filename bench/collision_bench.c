@@ -0,0 +1,193 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "collision.h"
+#include "shapelib.h"
+
+//Each timing repeats its pairs until it has run for at least this long.
+const double MIN_SECONDS = 0.2;
+const double RADIUS = 10;
+//Pairs per polygon size in the SAT table.
+const size_t SAT_PAIRS = 256;
+//Pairs per polygon size in the crossover table.
+const size_t CROSSOVER_PAIRS = 128;
+
+typedef collision_info_t (*collision_func_t)(list_t *shape1, list_t *shape2);
+
+double now(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+double random_between(double low, double high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+//A regular n-gon turned by a random angle.
+list_t *random_polygon(size_t sides, vector_t center) {
+    list_t *shape = compute_circle_points(center, RADIUS, sides);
+    polygon_rotate(shape, random_between(0, 2 * M_PI), center);
+    return shape;
+}
+
+//Fills shapes with count pairs of n-gons whose centers are at most spread apart.
+void make_pairs(list_t **shapes, size_t count, size_t sides, double spread) {
+    for (size_t i = 0; i < count; i++) {
+        vector_t offset = {random_between(-spread, spread), random_between(-spread, spread)};
+        shapes[2 * i] = random_polygon(sides, VEC_ZERO);
+        shapes[2 * i + 1] = random_polygon(sides, offset);
+    }
+}
+
+void free_pairs(list_t **shapes, size_t count) {
+    for (size_t i = 0; i < 2 * count; i++) {
+        list_free(shapes[i]);
+    }
+}
+
+//Returns the mean nanoseconds per call of test over the pairs.
+double time_pairs(collision_func_t test, list_t **shapes, size_t count) {
+    size_t calls = 0;
+    //Kept so the compiler cannot drop the calls.
+    double total = 0;
+    double start = now();
+    double elapsed = 0;
+    while (elapsed < MIN_SECONDS) {
+        for (size_t i = 0; i < count; i++) {
+            total += test(shapes[2 * i], shapes[2 * i + 1]).overlap;
+        }
+        calls += count;
+        elapsed = now() - start;
+    }
+    if (total < 0) {
+        printf("negative overlap\n");
+    }
+    return elapsed * 1e9 / calls;
+}
+
+//The separating axis test as it was before the shapes were copied into
+//flat arrays: one vertex onto one axis at a time, through list_get(),
+//with each edge normal malloc'd. Kept to measure the flat version against.
+typedef struct {
+    double min;
+    double max;
+} projection_t;
+
+list_t *reference_axes(list_t *shape) {
+    size_t size = list_size(shape);
+    list_t *axes = list_init(size, free);
+    for (size_t i = 0; i < size; i++) {
+        vector_t *axis = malloc(sizeof(vector_t));
+        vector_t tangent = vec_unit(vec_subtract(*(vector_t *) list_get(shape, (i + 1) % size),
+                                                 *(vector_t *) list_get(shape, i)));
+        *axis = (vector_t) {tangent.y, -tangent.x};
+        list_add(axes, axis);
+    }
+    return axes;
+}
+
+projection_t reference_project(vector_t *axis, list_t *shape) {
+    double first = vec_dot(*(vector_t *) list_get(shape, 0), *axis);
+    projection_t projection = {first, first};
+    for (size_t i = 1; i < list_size(shape); i++) {
+        double distance = vec_dot(*(vector_t *) list_get(shape, i), *axis);
+        projection.min = fmin(projection.min, distance);
+        projection.max = fmax(projection.max, distance);
+    }
+    return projection;
+}
+
+//Finds the overlap of two shapes' projections onto an axis, or 0 if they are apart.
+double reference_overlap_on(vector_t *axis, list_t *shape1, list_t *shape2) {
+    projection_t projection1 = reference_project(axis, shape1);
+    projection_t projection2 = reference_project(axis, shape2);
+    if (!(projection2.max > projection1.min && projection1.max > projection2.min)) {
+        return 0;
+    }
+    return fmin(projection1.max, projection2.max) - fmax(projection1.min, projection2.min);
+}
+
+//Finds the smallest overlap over some axes, or 0 if one of them separates.
+double reference_overlap(list_t *axes, list_t *shape1, list_t *shape2) {
+    double min_overlap = INFINITY;
+    for (size_t i = 0; i < list_size(axes); i++) {
+        double overlap = reference_overlap_on(list_get(axes, i), shape1, shape2);
+        if (overlap == 0) {
+            return 0;
+        }
+        min_overlap = fmin(min_overlap, overlap);
+    }
+    return min_overlap;
+}
+
+collision_info_t reference_collision(list_t *shape1, list_t *shape2) {
+    collision_info_t collision = {false, VEC_ZERO, 0};
+    vector_t x_axis = {1, 0};
+    vector_t y_axis = {0, 1};
+    //The bounding boxes are checked first, as find_collision() does.
+    if (reference_overlap_on(&x_axis, shape1, shape2) == 0 ||
+            reference_overlap_on(&y_axis, shape1, shape2) == 0) {
+        return collision;
+    }
+    list_t *axes1 = reference_axes(shape1);
+    list_t *axes2 = reference_axes(shape2);
+    double overlap1 = reference_overlap(axes1, shape1, shape2);
+    double overlap2 = overlap1 > 0 ? reference_overlap(axes2, shape1, shape2) : 0;
+    list_free(axes1);
+    list_free(axes2);
+    if (overlap1 > 0 && overlap2 > 0) {
+        collision.collided = true;
+        collision.overlap = fmin(overlap1, overlap2);
+    }
+    return collision;
+}
+
+//Compares the list-based SAT with find_collision_sat() on pairs of
+//n-gons placed so that about half of them collide.
+void sat_table(void) {
+    size_t sizes[] = {4, 8, 16, 32, 64};
+    list_t **shapes = malloc(sizeof(list_t *) * 2 * SAT_PAIRS);
+    assert(shapes != NULL);
+    printf("SAT, %zu random pairs of regular n-gons, ns per call\n", SAT_PAIRS);
+    printf("%6s %12s %12s %8s\n", "n", "list-based", "flat", "speedup");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        make_pairs(shapes, SAT_PAIRS, sizes[i], 2.5 * RADIUS);
+        double reference = time_pairs(reference_collision, shapes, SAT_PAIRS);
+        double flat = time_pairs(find_collision_sat, shapes, SAT_PAIRS);
+        printf("%6zu %12.0f %12.0f %7.1fx\n", sizes[i], reference, flat, reference / flat);
+        free_pairs(shapes, SAT_PAIRS);
+    }
+    free(shapes);
+    printf("\n");
+}
+
+//Compares SAT with GJK and EPA on mostly overlapping pairs of n-gons,
+//and shows which of them find_collision() picks.
+void crossover_table(void) {
+    size_t sizes[] = {4, 8, 16, 24, 32, 36, 40, 48, 64, 128};
+    list_t **shapes = malloc(sizeof(list_t *) * 2 * CROSSOVER_PAIRS);
+    assert(shapes != NULL);
+    printf("SAT against GJK, %zu mostly overlapping pairs of n-gons, ns per call\n",
+           CROSSOVER_PAIRS);
+    printf("%9s %10s %10s %10s\n", "vertices", "SAT", "GJK", "picked");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        make_pairs(shapes, CROSSOVER_PAIRS, sizes[i], RADIUS);
+        double sat = time_pairs(find_collision_sat, shapes, CROSSOVER_PAIRS);
+        double gjk = time_pairs(find_collision_gjk, shapes, CROSSOVER_PAIRS);
+        double picked = time_pairs(find_collision, shapes, CROSSOVER_PAIRS);
+        printf("%4zu+%-4zu %10.0f %10.0f %10.0f\n", sizes[i], sizes[i], sat, gjk, picked);
+        free_pairs(shapes, CROSSOVER_PAIRS);
+    }
+    free(shapes);
+    printf("\n");
+}
+
+int main(void) {
+    srand(42);
+    sat_table();
+    crossover_table();
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "forces.h"
+#include "shapelib.h"
+
+const size_t DEFAULT_BODIES = 1000;
+//Above this many bodies, one force per pair takes too much memory,
+//so the field with theta = 0 (exact) is the reference instead.
+const size_t MAX_PAIRWISE_BODIES = 3000;
+const double G = 1000;
+const size_t GRAVITY_TYPE = 7;
+//Bodies are scattered uniformly over a square this wide.
+const double WORLD_SIZE = 10000;
+//Short enough that a tick leaves every body where it was,
+//so each body's force can be read back from its velocity.
+const double TICK = 1e-9;
+
+double now(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Makes a scene of n small squares with masses from 1 to 10, the same every call.
+scene_t *make_scene(size_t n, body_t **bodies) {
+    srand(42);
+    scene_t *scene = scene_init();
+    for (size_t i = 0; i < n; i++) {
+        vector_t center = {WORLD_SIZE * rand() / RAND_MAX, WORLD_SIZE * rand() / RAND_MAX};
+        bodies[i] = body_init(compute_rect_points(center, 2, 2), 1 + rand() % 10);
+        scene_add_body(scene, bodies[i]);
+        scene_set_type(scene, bodies[i], GRAVITY_TYPE);
+    }
+    return scene;
+}
+
+//Ticks a scene once, then writes the force on each body to forces.
+//Returns the seconds the tick took.
+double measure_tick(scene_t *scene, body_t **bodies, size_t n, vector_t *forces) {
+    double start = now();
+    scene_tick(scene, TICK);
+    double elapsed = now() - start;
+    for (size_t i = 0; i < n; i++) {
+        forces[i] = vec_multiply(body_get_mass(bodies[i]) / TICK, body_get_velocity(bodies[i]));
+    }
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? (size_t) atol(argv[1]) : DEFAULT_BODIES;
+    body_t **bodies = malloc(sizeof(body_t *) * n);
+    vector_t *exact = malloc(sizeof(vector_t) * n);
+    vector_t *forces = malloc(sizeof(vector_t) * n);
+    assert(bodies != NULL && exact != NULL && forces != NULL);
+    printf("Gravity between %zu bodies, one tick\n", n);
+
+    bool pairwise = n <= MAX_PAIRWISE_BODIES;
+    if (pairwise) {
+        scene_t *scene = make_scene(n, bodies);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = i + 1; j < n; j++) {
+                create_newtonian_gravity(scene, G, bodies[i], bodies[j]);
+            }
+        }
+        printf("%-10s %9.4fs\n", "pairwise", measure_tick(scene, bodies, n, exact));
+        scene_free(scene);
+    }
+
+    double thetas[] = {0, 0.3, 0.5, 0.8, 1.0};
+    printf("%-10s %10s %14s %14s\n", "theta", "tick", "mean rel err", "max rel err");
+    for (size_t k = 0; k < sizeof(thetas) / sizeof(thetas[0]); k++) {
+        scene_t *scene = make_scene(n, bodies);
+        create_gravity_field(scene, G, thetas[k], GRAVITY_TYPE);
+        double elapsed = measure_tick(scene, bodies, n, forces);
+        if (!pairwise && thetas[k] == 0) {
+            for (size_t i = 0; i < n; i++) {
+                exact[i] = forces[i];
+            }
+        }
+        double total_error = 0;
+        double max_error = 0;
+        for (size_t i = 0; i < n; i++) {
+            double error = vec_mag(vec_subtract(forces[i], exact[i])) /
+                           fmax(vec_mag(exact[i]), 1e-30);
+            total_error += error;
+            max_error = fmax(max_error, error);
+        }
+        printf("%-10.1f %9.4fs %14.2e %14.2e\n", thetas[k], elapsed, total_error / n, max_error);
+        scene_free(scene);
+    }
+
+    free(bodies);
+    free(exact);
+    free(forces);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "forces.h"
+#include "jobs.h"
+#include "shapelib.h"
+
+//The bodies sit on a square lattice, this many on a side.
+const size_t LATTICE_SIDE = 100;
+const double SPACING = 10;
+const double BODY_RADIUS = 4;
+const double BODY_SIDES = 8;
+const double DRAG_GAMMA = 0.1;
+const double SPRING_CONSTANT = 5;
+const double ELASTICITY = 0.5;
+const size_t TICKS = 100;
+const double DT = 1.0 / 60;
+
+double now(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+//Makes a scene whose tick is all parallel work: drag on every body,
+//springs and physics collisions between lattice neighbours.
+scene_t *make_scene(void) {
+    srand(42);
+    scene_t *scene = scene_init();
+    size_t n = LATTICE_SIDE * LATTICE_SIDE;
+    for (size_t i = 0; i < n; i++) {
+        vector_t center = {SPACING * (i % LATTICE_SIDE), SPACING * (i / LATTICE_SIDE)};
+        body_t *body = body_init(compute_circle_points(center, BODY_RADIUS, BODY_SIDES), 1);
+        body_set_velocity(body, (vector_t) {rand() % 21 - 10, rand() % 21 - 10});
+        scene_add_body(scene, body);
+        create_drag(scene, DRAG_GAMMA, body);
+    }
+    for (size_t i = 0; i < n; i++) {
+        body_t *body = scene_get_body(scene, i);
+        if (i % LATTICE_SIDE + 1 < LATTICE_SIDE) {
+            create_spring(scene, SPRING_CONSTANT, body, scene_get_body(scene, i + 1));
+            create_physics_collision(scene, ELASTICITY, body, scene_get_body(scene, i + 1));
+        }
+        if (i + LATTICE_SIDE < n) {
+            create_physics_collision(scene, ELASTICITY, body,
+                                     scene_get_body(scene, i + LATTICE_SIDE));
+        }
+    }
+    return scene;
+}
+
+//Sums the bodies' coordinates, which match across thread counts
+//since the threads add forces in the same order as one thread would.
+double checksum(scene_t *scene) {
+    double sum = 0;
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+        vector_t centroid = body_get_centroid(scene_get_body(scene, i));
+        sum += centroid.x + centroid.y;
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    size_t default_threads[] = {1, 2, 4, 8, 16};
+    size_t num_runs = argc > 1 ? (size_t) argc - 1
+                               : sizeof(default_threads) / sizeof(default_threads[0]);
+    printf("Tick of %zu bodies with drag, springs and collisions, %zu ticks\n",
+           LATTICE_SIDE * LATTICE_SIDE, TICKS);
+    printf("%8s %12s %8s %20s\n", "threads", "ms per tick", "speedup", "checksum");
+    double serial = 0;
+    for (size_t run = 0; run < num_runs; run++) {
+        size_t threads = argc > 1 ? (size_t) atol(argv[run + 1]) : default_threads[run];
+        assert(threads >= 1);
+        scene_t *scene = make_scene();
+        job_pool_t *pool = threads > 1 ? job_pool_init(threads) : NULL;
+        scene_set_job_pool(scene, pool);
+        double start = now();
+        for (size_t i = 0; i < TICKS; i++) {
+            scene_tick(scene, DT);
+        }
+        double per_tick = (now() - start) / TICKS;
+        if (run == 0) {
+            serial = per_tick;
+        }
+        printf("%8zu %12.3f %7.2fx %20.12e\n", threads, per_tick * 1e3, serial / per_tick,
+               checksum(scene));
+        scene_free(scene);
+        if (pool != NULL) {
+            job_pool_free(pool);
+        }
+    }
+    return 0;
+}
@@ -15,6 +15,7 @@
 #include "shapelib.h"
 #include "bounds.h"
 #include "forces.h"
+#include "solver.h"
 
 const vector_t MIN = {.x = 0, .y = 0};
 const vector_t MAX = {.x = 1000, .y = 500};
@@ -26,7 +27,15 @@ const char *SHOOT_ADD = "sounds/shoot.wav";
 
 const int ARC_RESOLUTION = 10;
 
-const double MAX_DT = 0.01;
+//Springs and drag are stable at any tick length; this keeps fast bodies
+//from passing through thin platforms when a frame is slow.
+const double MAX_DT = 1.0 / 30;
+//Most threads the scene may use to tick, including the main thread.
+const size_t MAX_TICK_THREADS = 4;
+//Bodies each tick thread needs before a job pool is worth starting.
+//The game's scenes hold a few hundred, so they tick on the main thread;
+//see bench/tick_bench.c for the 10000-body scene this is sized against.
+const size_t BODIES_PER_TICK_THREAD = 2500;
 const double MIN_DT = 1e-6;
 
 const double BULLET_RADIUS = 6;
@@ -41,6 +50,8 @@ const vector_t DEFAULT_GRAVITY = {0, -1000};
 const vector_t DEFAULT_SCROLL_SPEED = {-200, 0};
 const double DEFAULT_SPEEDUP = -50;
 const double MAX_SPEED = 700;
+//How far the camera scrolls before the level is moved back to the origin.
+const double REBASE_DISTANCE = 10000;
 
 const double PLAYER_SPEED = 600;
 const double PLAYER_RADIUS = 30;
@@ -131,24 +142,19 @@ double advanced_score_calculation(double dt) {
 
 //Check if player is gone: lose the game.
 bool check_game_end(scene_t *scene) {
-    entity_t *entity = body_get_info(scene_get_body(scene, 3));
-    if (strcmp(entity_get_type(entity), "PLAYER")) {
-        return true;
-    }
-    return false;
+    return component_pool_size(scene_get_components(scene, &PLAYER_STATE)) == 0;
 }
 
 //Adds a scrolling background to the scene.
 void add_background(scene_t *scene, const char* img, int speed){
     vector_t center = {MAX.x / 2, MAX.y / 2};
     list_t *window = compute_rect_points(center, MAX.x, MAX.y);
-    entity_t *info = entity_init("BACKGROUND", false, false);
-    body_t *background = body_init_with_info(window, INFINITY, info , entity_free);
+    body_t *background = body_init(window, INFINITY);
     SDL_Rect *frame = malloc(sizeof(SDL_Rect));
     *frame = BACKGROUND_FRAME;
-    sprite_t *back_info = sprite_scroll(img, speed, frame);
+    sprite_t *back_info = sprite_scroll(scene_get_context(scene), img, speed, frame);
     body_set_draw(background, sdl_draw_scroll, back_info, sprite_free); 
-    scene_add_body(scene, background);
+    entity_add(scene, background, ENTITY_BACKGROUND);
 }
 
 //Adds text to a scene.
@@ -186,30 +192,27 @@ void initialize_background(scene_t *scene){
 //Initializes player attributes.
 void initialize_player(scene_t *scene) {
     vector_t center = {MAX.x / 2, MAX.y - PLAYER_RADIUS};
-    player_entity_t *entity = player_entity_init("PLAYER", false, true);
     list_t *coords = compute_rect_points(center, 2 * PLAYER_RADIUS, 2 * PLAYER_RADIUS);
-    body_t *player = body_init_with_info(coords, PLAYER_MASS, entity, entity_free);
-    sprite_t *sprite_player = sprite_animated(PLAYER_SPRITE, 
-                                              PLAYER_SCALE, 
+    body_t *player = body_init(coords, PLAYER_MASS);
+    sprite_t *sprite_player = sprite_animated(scene_get_context(scene),
+                                              PLAYER_SPRITE,
+                                              PLAYER_SCALE,
                                               PLAYER_FRAMES, 
                                               PLAYER_FPS);
     body_set_draw(player, (draw_func_t) sdl_draw_animated, sprite_player, sprite_free);
-    scene_add_body(scene, player);
-    vector_t *grav = malloc(sizeof(vector_t));
-    *grav = DEFAULT_GRAVITY;
-    create_constant_force(scene, grav, player, free);
+    entity_add(scene, player, ENTITY_PLAYER);
+    entity_add_player_state(scene, player);
+    solver_add_mover(scene, player);
 }
 
 //Initializes starter terrain.
 void initialize_terrain(scene_t *scene) {
-    body_t *player = scene_get_body(scene, 3);
     vector_t center = (vector_t){MAX.x/2, 10};
-    entity_t *entity = entity_init("TERRAIN", true, false);
     list_t *floor_coords = compute_rect_points(center, MAX.x, 50);
-    body_t *floor = body_init_with_info(floor_coords, INFINITY, entity, entity_free);
-    scene_add_body(scene, floor);
-    create_normal_collision(scene, vec_negate(DEFAULT_GRAVITY), player, floor);
-    create_terrain_collisions(scene, floor);
+    body_t *floor = body_init(floor_coords, INFINITY);
+    entity_add(scene, floor, ENTITY_TERRAIN);
+    solver_add_terrain(scene, floor, false);
+    create_terrain_culling(scene, floor);
 
     rgb_color_t *black = malloc(sizeof(rgb_color_t));
     *black = BLACK;
@@ -218,40 +221,52 @@ void initialize_terrain(scene_t *scene) {
 
 //Adds a bullet to the scene.
 void add_bullet (scene_t *scene, vector_t center, vector_t velocity,
-                 entity_t *bullet_entity, char *target_type) {
-    body_t *bullet = body_init_with_info(
-        compute_circle_points(center, BULLET_RADIUS, ARC_RESOLUTION),
-        BULLET_MASS, bullet_entity, entity_free);
+                 entity_type_t target_type) {
+    body_t *bullet = body_init(
+        compute_circle_points(center, BULLET_RADIUS, ARC_RESOLUTION), BULLET_MASS);
     body_set_velocity(bullet, velocity);
-    sprite_t *bullet_info = sprite_image(BULLET_SPRITE, 1, NULL);
+    body_set_circle(bullet, BULLET_RADIUS);
+    sprite_t *bullet_info = sprite_image(scene_get_context(scene), BULLET_SPRITE, 1, NULL);
     body_set_draw(bullet, (draw_func_t) sdl_draw_image, bullet_info, sprite_free);
-    scene_add_body(scene, bullet);
-    create_bounds_collisions(scene, bullet, BULLET_RADIUS);
-
-    for (size_t i = 0; i < scene_bodies(scene); i++) {
-        body_t *body = scene_get_body(scene, i);
-        entity_t *entity = body_get_info(body);
-        if (!strcmp(entity_get_type(entity), target_type)) {
-            create_destructive_collision(scene, body, bullet);
-        }
+    entity_add(scene, bullet, ENTITY_BULLET);
+    create_bounds_culling(scene, bullet, BULLET_RADIUS);
+
+    component_pool_t *targets = scene_get_bodies_of_type(scene, target_type);
+    body_t **bodies = component_pool_bodies(targets);
+    for (size_t i = 0; i < component_pool_size(targets); i++) {
+        create_destructive_collision(scene, bodies[i], bullet);
     }
 }
 
-//Applies a leftwards velocity to all bodies with the "SCROLLABLE" tag.
-void sidescroll(scene_t *scene, vector_t *scroll_speed, double dt) {
-    for (size_t i = 0; i < scene_bodies(scene); i++) {
-        body_t *body = scene_get_body(scene, i);
-        entity_t *entity = body_get_info(body);
-        if(i < 3){
-            sprite_t *sprite = body_get_draw_info(body);
-            sprite_set_speed(sprite, (int)abs((int)(scroll_speed->x) *((int)i+1) /18));
-        }
-        if (entity_get_scrollable(entity) && !entity_is_scrolling(entity)) {
-            vector_t scroll = {scroll_speed->x, body_get_velocity(body).y};
-            body_set_velocity(body, scroll);
-            //Ensures that enemies (which accelerate) only get a velocity assigned once
-            if (!strcmp(entity_get_type(entity), "ENEMY")) entity_set_scrolling(entity);
-        }
+//Starts a job pool for the scene once it holds enough bodies to split
+//its tick across two or more threads. Returns the pool, or NULL until then.
+job_pool_t *size_tick_pool(scene_t *scene, job_pool_t *pool) {
+    if (pool != NULL) {
+        return pool;
+    }
+    size_t threads = scene_bodies(scene) / BODIES_PER_TICK_THREAD;
+    if (threads < 2) {
+        return NULL;
+    }
+    pool = job_pool_init(threads < MAX_TICK_THREADS ? threads : MAX_TICK_THREADS);
+    scene_set_job_pool(scene, pool);
+    return pool;
+}
+
+//Moves the camera rightwards at the scroll speed, so the level scrolls past
+//the screen without moving. The player keeps its speed relative to the camera.
+void sidescroll(scene_t *scene, vector_t *scroll_speed) {
+    vector_t camera_velocity = vec_negate(*scroll_speed);
+    vector_t change = vec_subtract(camera_velocity, scene_get_camera_velocity(scene));
+    if (change.x == 0 && change.y == 0) {
+        return;
+    }
+    scene_set_camera_velocity(scene, camera_velocity);
+    body_t *player = scene_get_body(scene, 3);
+    body_set_velocity(player, vec_add(body_get_velocity(player), change));
+    for (int i = 0; i < 3; i++) {
+        sprite_t *sprite = body_get_draw_info(scene_get_body(scene, i));
+        sprite_set_speed(sprite, (int)abs((int)(scroll_speed->x) *(i+1) /18));
     }
 }
 
@@ -260,30 +275,31 @@ void player_move (char key, key_event_type_t type, double held_time, void *scene
     Mix_Chunk *jump = loadEffects(JUMP_ADD);
     Mix_Chunk *slide = loadEffects(SLIDE_ADD);
     body_t *player = scene_get_body(scene, 3);
-    player_entity_t *entity = body_get_info(player);
-    vector_t new_velocity = {0, body_get_velocity(player).y};
+    player_state_t *entity = entity_get_player_state(scene, player);
+    //The player's speed is relative to the camera.
+    double camera_speed = scene_get_camera_velocity(scene).x;
+    vector_t new_velocity = {camera_speed, body_get_velocity(player).y};
     if (type == KEY_PRESSED) {
         switch (key) {
             case LEFT_ARROW: {
-                new_velocity.x = -PLAYER_SPEED;
+                new_velocity.x = camera_speed - PLAYER_SPEED;
                 if (held_time < 0.2) {
                     Mix_PlayChannel(-1, slide, 0);
                 }
                 break;
             }
             case RIGHT_ARROW: {
-                new_velocity.x = PLAYER_SPEED;
+                new_velocity.x = camera_speed + PLAYER_SPEED;
                 if (held_time < 0.2) {
                     Mix_PlayChannel(-1, slide, 0);
                 }
                 break;
             }
             case UP_ARROW: {
-                if (held_time < 0.2 && (entity_get_colliding(entity) ||
-                                        !strcmp(entity_get_powerup(entity), "JUMP"))) {
+                if (held_time < 0.2 && (solver_is_grounded(scene, player) ||
+                                        entity_get_powerup(entity) == POWERUP_JUMP)) {
                     new_velocity.y = PLAYER_SPEED;
                     Mix_PlayChannel(-1, jump, 0);
-                    entity_set_colliding(entity, false);
                 }
                 break;
             }
@@ -300,12 +316,20 @@ void player_shoot(char key, mouse_event_type_t type, double held_time, void *sce
     if (type == BUTTON_PRESSED) {
         switch (key) {
             case LEFT_CLICK: {
-                vector_t mouse = sdl_mouse_pos();
+                vector_t mouse = vec_add(sdl_mouse_pos(scene_get_context(scene)),
+                                         scene_get_camera(scene));
+                //Clicking on an enemy aims at its center.
+                body_t *target;
+                if (scene_query_point(scene, mouse, (uint64_t) 1 << ENTITY_ENEMY,
+                                      &target, 1) > 0) {
+                    mouse = body_get_centroid(target);
+                }
                 vector_t center = body_get_centroid(player);
                 vector_t shoot = vec_unit(vec_subtract(mouse, center));
-                entity_t *entity = entity_init("BULLET", false, false);
+                vector_t velocity = vec_add(vec_multiply(200, shoot),
+                                            scene_get_camera_velocity(scene));
                 Mix_PlayChannel(-1, shot, 0);
-                add_bullet(scene, center, vec_multiply(200, shoot), entity, "ENEMY");
+                add_bullet(scene, center, velocity, ENTITY_ENEMY);
                 break;
             }
         }
@@ -314,16 +338,16 @@ void player_shoot(char key, mouse_event_type_t type, double held_time, void *sce
 
 //Allows the program to continue when a key is pressed.
 void click_to_continue(char key, mouse_event_type_t type, double held_time,
-                        void *window){
+                        void *context){
     if (type == BUTTON_PRESSED) {
         switch (key) {
             case LEFT_CLICK: {
                 SDL_Event *event = malloc(sizeof(event));
                 event->type = SDL_QUIT;
                 SDL_PushEvent(event);
-                sdl_clear();
-                sdl_on_key(NULL);
-                sdl_on_click(NULL);
+                sdl_clear(context);
+                sdl_on_key(context, NULL);
+                sdl_on_click(context, NULL);
                 break;
             }
         }
@@ -331,8 +355,9 @@ void click_to_continue(char key, mouse_event_type_t type, double held_time,
 }
 
 //Displays the main menu selection screen.
-void display_main_menu(SDL_Window *window) {
+void display_main_menu(sdl_context_t *context) {
     scene_t *scene = scene_init();
+    scene_set_context(scene, context);
     add_background(scene, BACKGROUND_IMG, 0);
 
     char *text = "TURTLE RUN";
@@ -360,16 +385,17 @@ void display_main_menu(SDL_Window *window) {
                         TEXT_SPACING*5};
     add_text(scene, center, text, true, false);
 
-    sdl_render_scene(scene);
+    sdl_render_scene(context, scene);
     scene_free(scene);
 }
 
 //Displays a player's score after a game.
-void display_score(SDL_Window *window, list_t *achievements, double *score) {
-    sdl_clear();
-    sdl_on_click((event_handler_t)click_to_continue);
+void display_score(sdl_context_t *context, list_t *achievements, double *score) {
+    sdl_clear(context);
+    sdl_on_click(context, (event_handler_t)click_to_continue);
 
     scene_t *scene = scene_init();
+    scene_set_context(scene, context);
     add_background(scene, BACKGROUND_IMG, 0);
 
     char *text = "FINAL SCORE";
@@ -424,20 +450,23 @@ void display_score(SDL_Window *window, list_t *achievements, double *score) {
     center = (vector_t){MIN.x+TEXT_OFFSET, SMALL_TEXT_SPACING*10};
     add_text(scene, center, text, true, true);
 
-    sdl_render_scene(scene);
+    sdl_render_scene(context, scene);
     scene_free(scene);
 
-    while (!sdl_is_done(window)) {
+    while (!sdl_is_done(context, context)) {
     }
 }
 
 //Plays a game of Turtle Run.
-void menu_play_game(SDL_Window *window) {
-    sdl_clear();
-    sdl_on_key((event_handler_t) player_move);
-    sdl_on_click((event_handler_t) player_shoot);
+void menu_play_game(sdl_context_t *context) {
+    sdl_clear(context);
+    sdl_on_key(context, (event_handler_t) player_move);
+    sdl_on_click(context, (event_handler_t) player_shoot);
 
     scene_t *scene = scene_init();
+    scene_set_context(scene, context);
+    scene_seed(scene, (unsigned int) time(NULL));
+    job_pool_t *pool = NULL;
     vector_t *scroll_speed = malloc(sizeof(vector_t));
     *scroll_speed = DEFAULT_SCROLL_SPEED;
     double *score = malloc(sizeof(double));
@@ -450,20 +479,23 @@ void menu_play_game(SDL_Window *window) {
     }
 
     initialize_background(scene);
+    create_force_field(scene, DEFAULT_GRAVITY, AABB_EVERYWHERE,
+                       (uint64_t) 1 << ENTITY_PLAYER);
     initialize_player(scene);
     initialize_bounds(scene, MIN, MAX);
     initialize_terrain(scene);
-    frame_spawn_random(scene, MAX, MAX.x, score, achievements);
+    double next_frame_start = MAX.x;
+    frame_spawn_random(scene, MAX, next_frame_start, score, achievements);
+    next_frame_start += MAX.x;
 
     body_t *player = scene_get_body(scene, 3);
-    player_entity_t *player_entity = body_get_info(player);
-    create_bounds_collisions(scene, player, PLAYER_RADIUS);
+    player_state_t *player_state = entity_get_player_state(scene, player);
+    create_bounds_culling(scene, player, PLAYER_RADIUS);
 
     double total_time = 0.0;
     double time_since_last_enemy = 0;
     double time_since_last_powerup = 0;
     double time_since_last_speedup = 0;
-    double distance_since_last_frame = 0;
 
     char *score_text = malloc(sizeof(char)*(DBL_DIG) + 1);
     sprintf(score_text, "%.0f", *score);
@@ -483,7 +515,7 @@ void menu_play_game(SDL_Window *window) {
     );
 
     char *powerup_text = malloc(sizeof(char)*(DBL_DIG) + 1);
-    sprintf(powerup_text, "%s", entity_get_powerup(player_entity));
+    sprintf(powerup_text, "%s", entity_powerup_name(entity_get_powerup(player_state)));
     vector_t powerup_coords = {TEXT_OFFSET, TEXT_HEIGHT+SMALL_TEXT_HEIGHT+TEXT_OFFSET};
     text_info_t *powerup_text_info = text_info_init(
         powerup_text,
@@ -494,29 +526,35 @@ void menu_play_game(SDL_Window *window) {
     );
 
     //Every tick inside "Play Game":
-    while (!sdl_is_done(scene)) {
-        double dt = fmax(fmin(time_since_last_tick(), MAX_DT), MIN_DT);
+    while (!sdl_is_done(context, scene)) {
+        double dt = fmax(fmin(time_since_last_tick(context), MAX_DT), MIN_DT);
         total_time += dt;
         time_since_last_enemy += dt;
-        distance_since_last_frame += dt*(-(scroll_speed->x));
         time_since_last_powerup += dt;
         time_since_last_speedup += dt;
+        if (scene_get_camera(scene).x > REBASE_DISTANCE) {
+            next_frame_start -= scene_get_camera(scene).x;
+            scene_rebase(scene, scene_get_camera(scene));
+        }
+        vector_t view_min = vec_add(MIN, scene_get_camera(scene));
+        vector_t view_max = vec_add(MAX, scene_get_camera(scene));
         if (time_since_last_enemy > ENEMY_INTERVAL) {
-            enemy_spawn_random(scene, MIN, MAX);
+            enemy_spawn_random(scene, view_min, view_max);
             time_since_last_enemy = 0;
         }
-        if (distance_since_last_frame >= MAX.x) {
-            frame_spawn_random(scene, MAX, MAX.x, score, achievements);
-            distance_since_last_frame = 0;
+        //The next frame is built once the last one is fully on screen.
+        if (view_max.x >= next_frame_start) {
+            frame_spawn_random(scene, MAX, next_frame_start, score, achievements);
+            next_frame_start += MAX.x;
         }
         if (time_since_last_powerup > POWERUP_INTERVAL) {
-            powerup_spawn_random(scene, MIN, MAX, scroll_speed, achievements);
+            powerup_spawn_random(scene, view_min, view_max, scroll_speed, achievements);
             time_since_last_powerup = 0;
         }
         if (time_since_last_speedup > SPEEDUP_INTERVAL) {
             scroll_speed->x = fmin(
                 scroll_speed->x + DEFAULT_SPEEDUP *
-                (strcmp(entity_get_powerup(player_entity), "SLOW")? 1:0.5),
+                (entity_get_powerup(player_state) == POWERUP_SLOW? 0.5:1),
                 MAX_SPEED);
             time_since_last_speedup = 0;
             for (int i = 0; i < 3 ; i++){
@@ -527,11 +565,12 @@ void menu_play_game(SDL_Window *window) {
         *score = *score + advanced_score_calculation(total_time);
         sprintf(score_text, "%.0f", *score);
         sprintf(coins_text, "%.0f", *(double *) list_get(achievements, 2));
-        sprintf(powerup_text, "%s", entity_get_powerup(player_entity));
+        sprintf(powerup_text, "%s", entity_powerup_name(entity_get_powerup(player_state)));
 
-        sidescroll(scene, scroll_speed, dt);
+        sidescroll(scene, scroll_speed);
+        pool = size_tick_pool(scene, pool);
         scene_tick(scene, dt);
-        sdl_render_scene_with_score(scene, score_text_info, coins_text_info,
+        sdl_render_scene_with_score(context, scene, score_text_info, coins_text_info,
                 powerup_text_info);
         if (check_game_end(scene)) {
             break;
@@ -571,20 +610,24 @@ void menu_play_game(SDL_Window *window) {
     fclose(highscores_file);
     list_free(highscores);
 
-    sdl_on_key(NULL);
-    sdl_on_click(NULL);
+    sdl_on_key(context, NULL);
+    sdl_on_click(context, NULL);
     scene_free(scene);
+    if (pool != NULL) {
+        job_pool_free(pool);
+    }
     free(scroll_speed);
 
-    display_score(window, achievements, score);
+    display_score(context, achievements, score);
 }
 
 //Displays the instructions for Turtle Run.
-void menu_instructions(SDL_Window *window) {
-    sdl_clear();
-    sdl_on_click((event_handler_t)click_to_continue);
+void menu_instructions(sdl_context_t *context) {
+    sdl_clear(context);
+    sdl_on_click(context, (event_handler_t)click_to_continue);
 
     scene_t *scene = scene_init();
+    scene_set_context(scene, context);
     add_background(scene, BACKGROUND_IMG, 0);
 
     char *text = "INSTRUCTIONS";
@@ -626,19 +669,20 @@ void menu_instructions(SDL_Window *window) {
     center = (vector_t){MIN.x + TEXT_OFFSET, SMALL_TEXT_SPACING*10};
     add_text(scene, center, text, true, true);
 
-    sdl_render_scene(scene);
+    sdl_render_scene(context, scene);
     scene_free(scene);
 
-    while (!sdl_is_done(window)) {
+    while (!sdl_is_done(context, context)) {
     }
 }
 
 //Displays the highscores and lifetime achievements for Turtle Run.
-void menu_highscores(SDL_Window *window) {
-    sdl_clear();
-    sdl_on_click((event_handler_t)click_to_continue);
+void menu_highscores(sdl_context_t *context) {
+    sdl_clear(context);
+    sdl_on_click(context, (event_handler_t)click_to_continue);
 
     scene_t *scene = scene_init();
+    scene_set_context(scene, context);
     add_background(scene, BACKGROUND_IMG, 0);
 
     list_t *achievements = get_global_achievements();
@@ -693,10 +737,10 @@ void menu_highscores(SDL_Window *window) {
     center = (vector_t){MIN.x+TEXT_OFFSET, SMALL_TEXT_SPACING*10};
     add_text(scene, center, text, true, true);
 
-    sdl_render_scene(scene);
+    sdl_render_scene(context, scene);
     scene_free(scene);
 
-    while (!sdl_is_done(window)) {
+    while (!sdl_is_done(context, context)) {
     }
 }
 
@@ -708,17 +752,17 @@ int is_in_button_bounds(double x, double y, vector_t box, int width) {
 
 //Declaration for menu mouse handler.
 void menu_mouse_handler(char key, mouse_event_type_t type, double held_time,
-                        void *window);
+                        void *context);
 
 //Focuses on and shows the main menu screen.
-void show_window(SDL_Window *window) {
-    sdl_on_click((event_handler_t)menu_mouse_handler);
-    display_main_menu(window);
+void show_window(sdl_context_t *context) {
+    sdl_on_click(context, (event_handler_t)menu_mouse_handler);
+    display_main_menu(context);
 }
 
 //Handles mouse selections on the main menu screen.
 void menu_mouse_handler(char key, mouse_event_type_t type, double held_time,
-                        void *window){
+                        void *context){
     vector_t box1 = {sdl_text_center(MIN, MAX, "Play Game", DEFAULT_FONT, TEXT_HEIGHT),
                      MAX.y - TEXT_SPACING*2};
     int width1 = sdl_text_width("Play Game", DEFAULT_FONT, TEXT_HEIGHT);
@@ -735,20 +779,20 @@ void menu_mouse_handler(char key, mouse_event_type_t type, double held_time,
     if (type == BUTTON_PRESSED) {
         switch (key) {
             case LEFT_CLICK: {
-                vector_t mouse_coords = sdl_mouse_pos();
+                vector_t mouse_coords = sdl_mouse_pos(context);
                 double x = mouse_coords.x;
                 double y = mouse_coords.y;
                 if (is_in_button_bounds(x, y, box1, width1)) {
-                    menu_play_game(window);
-                    show_window(window);
+                    menu_play_game(context);
+                    show_window(context);
                 }
                 else if (is_in_button_bounds(x, y, box2, width2)) {
-                    menu_instructions(window);
-                    show_window(window);
+                    menu_instructions(context);
+                    show_window(context);
                 }
                 else if (is_in_button_bounds(x, y, box3, width3)) {
-                    menu_highscores(window);
-                    show_window(window);
+                    menu_highscores(context);
+                    show_window(context);
                 }
                 else if (is_in_button_bounds(x, y, box4, width4)) {
                     SDL_Event *event = malloc(sizeof(event));
@@ -766,16 +810,13 @@ int main(int argc, char *argv[]) {
     Mix_Music *soundtrack = loadMedia(SOUNDTRACK_ADD);
     Mix_PlayMusic(soundtrack, -1);
 
-    time_t t;
-    srand((unsigned) time(&t));
-
-    SDL_Window *window = sdl_init(MIN,MAX);
-    display_main_menu(window);
-    sdl_on_click((event_handler_t) menu_mouse_handler);
+    sdl_context_t *context = sdl_init(MIN,MAX);
+    display_main_menu(context);
+    sdl_on_click(context, (event_handler_t) menu_mouse_handler);
 
-    while (!sdl_is_done(window)) {
+    while (!sdl_is_done(context, context)) {
     }
-    SDL_DestroyWindow(window);
+    sdl_free(context);
     Mix_HaltMusic();
     exit(0);
     return 0;
@@ -0,0 +1,59 @@
+#ifndef __AABB_H__
+#define __AABB_H__
+
+#include <stdbool.h>
+#include "list.h"
+#include "vector.h"
+
+/**
+ * An axis-aligned bounding box: the smallest rectangle with sides parallel
+ * to the axes that contains a shape.
+ * aabb_t is defined here instead of aabb.c because it is passed *by value*.
+ */
+typedef struct {
+    vector_t min;
+    vector_t max;
+} aabb_t;
+
+/**
+ * A box that contains every point, i.e. from (-INFINITY, -INFINITY)
+ * to (INFINITY, INFINITY).
+ */
+extern const aabb_t AABB_EVERYWHERE;
+
+/**
+ * Computes the bounding box of a polygon.
+ *
+ * @param polygon the list of vertices that make up the polygon
+ * @return the smallest box that contains every vertex
+ */
+aabb_t aabb_of_polygon(list_t *polygon);
+
+/**
+ * Grows a box by the same distance on every side.
+ *
+ * @param box the box to grow
+ * @param margin the distance to move each side outwards
+ * @return the grown box
+ */
+aabb_t aabb_expand(aabb_t box, double margin);
+
+/**
+ * Returns whether two boxes overlap. Boxes that only touch count as overlapping.
+ *
+ * @param box1 the first box
+ * @param box2 the second box
+ * @return whether any point lies in both boxes
+ */
+bool aabb_overlaps(aabb_t box1, aabb_t box2);
+
+/**
+ * Returns whether a box contains a point. Points on the edge count as inside.
+ *
+ * @param box the box
+ * @param point the point
+ * @return whether the point lies in the box
+ */
+bool aabb_contains(aabb_t box, vector_t point);
+
+#endif // #ifndef __AABB_H__
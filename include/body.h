@@ -2,6 +2,7 @@
 #define __BODY_H__
 
 #include <stdbool.h>
+#include "aabb.h"
 #include "list.h"
 #include "vector.h"
 /**
@@ -12,11 +13,29 @@
  */
 typedef struct body body_t;
 
+/**
+ * The shapes collisions can see a body as (see find_body_collision()).
+ * A round collider replaces the body's polygon in collisions only;
+ * the polygon is still what the body is drawn and weighed as.
+ */
+typedef enum {
+    /** The body's polygon (see body_get_shape()) */
+    COLLIDER_POLYGON,
+    /** A circle about the body's centroid (see body_set_circle()) */
+    COLLIDER_CIRCLE,
+    /** A segment through the body's centroid with rounded ends (see body_set_capsule()) */
+    COLLIDER_CAPSULE,
+    /** The number of collider types */
+    NUM_COLLIDER_TYPES
+} collider_type_t;
+
 /**
  * A function that can be called on body to draw it.
  * Examples: sdl_animate, sdl_draw_polygon
+ * The context is whatever is drawing the body (e.g. an sdl_context_t),
+ * passed through from body_draw().
  */
-typedef void (* draw_func_t)(body_t *body, void *aux);
+typedef void (* draw_func_t)(body_t *body, void *aux, void *context);
 
 /**
  * Initializes a body without any info.
@@ -59,6 +78,23 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets the number of vertices of a body's shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of vertices
+ */
+size_t body_num_vertices(body_t *body);
+
+/**
+ * Gets one vertex of a body's shape, without copying the whole shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param index the index of the vertex, less than body_num_vertices()
+ * @return the vertex at its current position
+ */
+vector_t body_get_vertex(body_t *body, size_t index);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -180,10 +216,43 @@ void body_add_force(body_t *body, vector_t force);
  */
 void body_add_impulse(body_t *body, vector_t impulse);
 
+/**
+ * Applies a force to a body over the current tick that varies linearly
+ * with the body's motion during the tick, e.g. a spring or drag:
+ * force - damping * velocity - stiffness * displacement, where the
+ * displacement is measured from a point moving at a reference velocity
+ * (e.g. the other end of a spring).
+ * body_tick() solves for the velocity at the end of the tick instead of
+ * using the force at the start, so stiff springs and heavy damping stay
+ * stable however long the tick is. Damping is integrated exactly, so a
+ * negative damping (which speeds the body up) grows it exponentially.
+ * Should not change the body's position or velocity; see body_tick().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param force the force at the body's current position, without damping
+ * @param damping how much the force opposes each unit of the body's velocity
+ * @param stiffness how much the force opposes each unit the body moves
+ *   relative to the reference
+ * @param reference the velocity over the tick of the point the
+ *   displacement is measured from
+ */
+void body_add_implicit_force(body_t *body, vector_t force, double damping,
+                             double stiffness, vector_t reference);
+
+/**
+ * Computes the velocity body_tick() would give a body,
+ * from the forces and impulses applied to it so far this tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param dt the number of seconds the tick lasts
+ * @return the velocity the body would have at the end of the tick
+ */
+vector_t body_predict_velocity(body_t *body, double dt);
+
 /**
  * Updates the body after a given time interval has elapsed.
  * Sets acceleration and velocity according to the forces and impulses
- * applied to the body during the tick.
+ * applied to the body during the tick (see body_predict_velocity()).
  * The body should be translated at the *average* of the velocities before
  * and after the tick.
  * Resets the forces and impulses accumulated on the body.
@@ -193,6 +262,102 @@ void body_add_impulse(body_t *body, vector_t impulse);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Computes the bounding box of a body's current shape,
+ * or of its round collider if it has one.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the smallest box that contains the body
+ */
+aabb_t body_get_aabb(body_t *body);
+
+/**
+ * Checks whether a body's shape is a rectangle with sides parallel to the axes
+ * (see polygon_is_rect()), e.g. one made by compute_rect_points() and not rotated.
+ * The shape is checked when the body is created and whenever it is rotated,
+ * so the collision code can test such bodies by their bounding boxes alone.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body's shape is the same as body_get_aabb()
+ */
+bool body_is_rect(body_t *body);
+
+/**
+ * Moves the sides of a body whose shape is an axis-aligned rectangle
+ * (see body_is_rect()) so that it covers a box, e.g. to widen a piece of
+ * terrain. Each vertex keeps its corner, so the shape keeps its vertex order
+ * and saved states of the body still load.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param box the box the body should cover
+ */
+void body_resize_rect(body_t *body, aabb_t box);
+
+/**
+ * Makes collisions see a body as a circle about its centroid,
+ * so testing it costs the same however many vertices its polygon has.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param radius the radius of the circle
+ */
+void body_set_circle(body_t *body, double radius);
+
+/**
+ * Makes collisions see a body as a capsule: the points within a radius of
+ * a segment through the body's centroid. The segment starts out horizontal
+ * and turns with the body (see body_set_rotation()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param length the length of the segment, not counting the rounded ends
+ * @param radius the radius of the rounded ends and the half-width of the capsule
+ */
+void body_set_capsule(body_t *body, double length, double radius);
+
+/**
+ * Gets the shape that collisions see a body as.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return COLLIDER_POLYGON unless body_set_circle() or body_set_capsule() was called
+ */
+collider_type_t body_get_collider(body_t *body);
+
+/**
+ * Gets the radius of a body's round collider.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the radius, or 0 for COLLIDER_POLYGON
+ */
+double body_get_radius(body_t *body);
+
+/**
+ * Gets the segment at the core of a body's round collider.
+ * A circle's segment is the single point at its centroid.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param start set to one end of the segment
+ * @param end set to the other end of the segment
+ */
+void body_get_segment(body_t *body, vector_t *start, vector_t *end);
+
+/**
+ * Lets the scene remove a body once it has left the scene's kill region
+ * (see scene_set_kill_region()). The body is removed when its bounding box
+ * lies entirely outside the kill region grown by margin on every side.
+ * Bodies start with a margin of INFINITY, so they are never removed this way.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param margin how far outside the kill region the body may go
+ */
+void body_set_cull_margin(body_t *body, double margin);
+
+/**
+ * Gets the margin set with body_set_cull_margin().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return how far outside the kill region the body may go
+ */
+double body_get_cull_margin(body_t *body);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return true.
  * Does not free the body.
@@ -212,12 +377,87 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
+/**
+ * Gets the forces that act on a body.
+ * The scene adds a force to this list when it is registered with the body
+ * and takes it out again when the force is retired, so removing the body
+ * only has to visit the forces in this list.
+ * The list does not own the forces; the scene frees them.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the list of forces registered with the body
+ */
+list_t *body_get_forces(body_t *body);
+
+/**
+ * Gets the number of bytes body_save_state() writes for a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the size of the body's saved state
+ */
+size_t body_state_size(body_t *body);
+
+/**
+ * Copies the motion state and vertices of a body into a buffer.
+ * The info, drawing information and forces of the body are not saved.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param buffer where to write body_state_size() bytes, aligned for a double
+ */
+void body_save_state(body_t *body, void *buffer);
+
+/**
+ * Sets a body back to a state saved with body_save_state().
+ * Asserts that the body still has the same number of vertices.
+ *
+ * @param body the body the state was saved from
+ * @param buffer the saved state
+ */
+void body_load_state(body_t *body, const void *buffer);
+
+/**
+ * Gets the ID of a body. The scene gives each body it holds a different ID,
+ * counting up from 0 and reusing the IDs of freed bodies,
+ * so IDs can index arrays (see component_pool_t).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the ID of the body
+ */
+size_t body_get_id(body_t *body);
+
+/**
+ * Sets the ID of a body. Only the scene should call this.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param id the new ID of the body
+ */
+void body_set_id(body_t *body, size_t id);
+
+/**
+ * Gets the type of a body, a small number such as an interned entity type.
+ * Bodies start with type 0.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the type of the body
+ */
+size_t body_get_type(body_t *body);
+
+/**
+ * Sets the type of a body. Use scene_set_type() instead,
+ * so the scene can index bodies by type.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param type the new type of the body
+ */
+void body_set_type(body_t *body, size_t type);
+
 /**
  * Draws the body.
  * If there is no draw funtion, nothing is drawn;
  *
- * @param body the body to mark for removal
+ * @param body the body to draw
+ * @param context the context to pass to the body's draw function
  */
-void body_draw(body_t *body);
+void body_draw(body_t *body, void *context);
 
 #endif // #ifndef __BODY_H__
@@ -2,6 +2,8 @@
 #define __COLLISION_H__
 
 #include <stdbool.h>
+#include "aabb.h"
+#include "body.h"
 #include "list.h"
 #include "vector.h"
 
@@ -16,17 +18,41 @@ typedef struct {
      * If the shapes are colliding, the axis they are colliding on.
      * This is a unit vector pointing from the first shape towards the second.
      * Normal impulses are applied along this axis.
-     * If collided is false, this value is undefined.
+     * If collided is false, this is an axis that separates the shapes,
+     * or VEC_ZERO if their bounding boxes do not overlap.
      */
     vector_t axis;
     double overlap;
+    /** The number of separating axes the shapes were projected onto */
+    size_t axes_tested;
+    /** Whether the hint passed to find_collision_with_hint() separated the shapes */
+    bool hint_separated;
 } collision_info_t;
 
+/**
+ * The most points two convex polygons touch at, e.g. along a shared edge.
+ */
+#define MAX_MANIFOLD_POINTS 2
+
+/**
+ * The points where two colliding shapes touch (see find_manifold()).
+ */
+typedef struct {
+    /** The number of points, from 0 to MAX_MANIFOLD_POINTS */
+    size_t count;
+    /** The points, each on the boundary of one shape and inside the other */
+    vector_t points[MAX_MANIFOLD_POINTS];
+    /** How far each point is inside the other shape */
+    double depths[MAX_MANIFOLD_POINTS];
+} manifold_t;
+
 /**
  * Computes the status of the collision between two convex polygons.
  * The shapes are given as lists of vertices in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
+ * Pairs with few vertices between them are tested with find_collision_sat(),
+ * and pairs with many (e.g. detailed circles and sectors) with find_collision_gjk().
  *
  * @param shape1 the first shape
  * @param shape2 the second shape
@@ -35,4 +61,157 @@ typedef struct {
  */
 collision_info_t find_collision(list_t *shape1, list_t *shape2);
 
+/**
+ * Tests two convex polygons for a collision with the separating axis test:
+ * both shapes are projected onto the edge normals of each,
+ * and the normal they overlap least on is the collision axis.
+ * Costs time proportional to the product of the numbers of vertices.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return the same as find_collision()
+ */
+collision_info_t find_collision_sat(list_t *shape1, list_t *shape2);
+
+/**
+ * Tests two convex polygons for a collision with GJK, and if they overlap,
+ * finds the collision axis with EPA. Both search the Minkowski difference
+ * of the shapes through its furthest points in chosen directions,
+ * so the cost grows with the sum of the numbers of vertices
+ * rather than their product. The axes_tested of the result counts
+ * the directions searched.
+ *
+ * The overlap is how far the shapes must move apart to separate. This is the
+ * same as find_collision_sat() unless one shape reaches past the other on
+ * both sides of the axis, where the separating axis test only measures
+ * the overlap of the projections.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return the same as find_collision()
+ */
+collision_info_t find_collision_gjk(list_t *shape1, list_t *shape2);
+
+/**
+ * Like find_collision(), but first tests an axis that is likely to separate
+ * the shapes, e.g. the one that separated them on the previous tick.
+ * Shapes move little from one tick to the next, so most pairs that are
+ * apart are settled by this one projection, without computing any edge normals.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @param hint an axis to test first, in either direction, or VEC_ZERO for none
+ * @return the same result as find_collision(), except that if hint separates
+ *   the shapes, the returned axis is hint
+ */
+collision_info_t find_collision_with_hint(list_t *shape1, list_t *shape2, vector_t hint);
+
+/**
+ * Like find_collision(), but for two rectangles with sides parallel to the axes,
+ * given by their bounding boxes. The only axes to test are x and y,
+ * so the overlaps are found without building any edge normals,
+ * and the result is the same as find_collision() on the rectangles' vertices.
+ *
+ * @param rect1 the first rectangle
+ * @param rect2 the second rectangle
+ * @return whether the rectangles are colliding, and if so, the collision axis,
+ *   which is a unit x or y vector pointing from rect1 towards rect2
+ */
+collision_info_t find_rect_collision(aabb_t rect1, aabb_t rect2);
+
+/**
+ * Tests two bodies for a collision, choosing the test by the bodies'
+ * collider types (see collider_type_t):
+ * - two polygons are tested with find_rect_collision() if both are axis-aligned
+ *   rectangles (see body_is_rect()), or else with find_collision_with_hint();
+ * - two circles or capsules are tested by the distance between their segments;
+ * - a circle or capsule and a polygon are tested against the polygon's edges,
+ *   so a circle costs the same as a point however finely it is drawn.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param hint an axis to test first if either body is not a rectangle,
+ *   or VEC_ZERO for none
+ * @return the result of the test, with the axis pointing from body1 towards body2
+ */
+collision_info_t find_body_collision(body_t *body1, body_t *body2, vector_t hint);
+
+/**
+ * Finds the points where two colliding convex polygons touch.
+ * The edge of one shape that faces the collision axis is the reference edge,
+ * and the facing edge of the other shape is clipped to the sides of it;
+ * the clipped points that are behind the reference edge are the contact points.
+ *
+ * @param shape1 the first shape, with vertices in counterclockwise order
+ * @param shape2 the second shape, with vertices in counterclockwise order
+ * @param axis the collision axis from find_collision(),
+ *   a unit vector pointing from shape1 towards shape2
+ * @return the contact points, of which there are none if the shapes do not overlap
+ */
+manifold_t find_manifold(list_t *shape1, list_t *shape2, vector_t axis);
+
+/**
+ * Like find_manifold(), but for two rectangles with sides parallel to the axes,
+ * given by their bounding boxes. The contact points are the ends of the side
+ * of rect2 that faces rect1, clipped to the sides of rect1.
+ *
+ * @param rect1 the first rectangle
+ * @param rect2 the second rectangle
+ * @param axis the collision axis from find_rect_collision()
+ * @return the contact points, of which there are none if the rectangles do not overlap
+ */
+manifold_t find_rect_manifold(aabb_t rect1, aabb_t rect2, vector_t axis);
+
+/**
+ * Finds the points where two colliding bodies touch,
+ * using find_rect_manifold() for pairs of axis-aligned rectangles
+ * and find_manifold() for other pairs of polygons.
+ * Where a circle or capsule touches, the points are on its boundary:
+ * one for a circle, and up to two for a capsule lying along the contact.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param axis the collision axis from find_body_collision()
+ * @return the contact points
+ */
+manifold_t find_body_manifold(body_t *body1, body_t *body2, vector_t axis);
+
+/**
+ * Where a ray first enters a body (see find_ray_hit()).
+ */
+typedef struct {
+    /** The body the ray hit */
+    body_t *body;
+    /** The point where the ray enters the body */
+    vector_t point;
+    /** The unit normal of the body's boundary at the point, facing the ray */
+    vector_t normal;
+    /** How far along the ray the point is, from 0 at its start to 1 at its end */
+    double fraction;
+} ray_hit_t;
+
+/**
+ * Checks whether a point is inside a body's collider
+ * (its polygon, circle or capsule; see collider_type_t).
+ * Points on the boundary count as inside.
+ *
+ * @param body the body
+ * @param point the point
+ * @return whether the point is inside the body
+ */
+bool find_point_in_body(body_t *body, vector_t point);
+
+/**
+ * Finds where a ray first enters a body's collider.
+ * A ray that starts inside the body hits it at its start,
+ * with the normal facing back along the ray.
+ *
+ * @param body the body
+ * @param start the start of the ray
+ * @param end the end of the ray
+ * @param hit set to where the ray enters the body, if it does
+ * @return whether the ray enters the body between its start and end
+ */
+bool find_ray_hit(body_t *body, vector_t start, vector_t end, ray_hit_t *hit);
+
 #endif // #ifndef __COLLISION_H__
@@ -0,0 +1,126 @@
+#ifndef __COMPONENT_H__
+#define __COMPONENT_H__
+
+#include <stddef.h>
+#include "body.h"
+
+/**
+ * Describes a kind of component: a block of plain data that some bodies carry
+ * (e.g. the state of the player, or whether a body scrolls with the screen).
+ * A kind may have a size of 0, in which case its pool only records which
+ * bodies have it.
+ * Kinds are compared by address, so each kind should be a single global constant.
+ */
+typedef struct {
+    /** A name for the kind, used when debugging */
+    const char *name;
+    /** The number of bytes in one component of this kind */
+    size_t size;
+    /**
+     * If non-NULL, called by component_pool_filter() on each component it
+     * would keep. Returning false takes the component away as well,
+     * e.g. because it points to a body that is being removed.
+     */
+    keep_func_t keep;
+} component_kind_t;
+
+/**
+ * Stores every component of one kind, packed into one array so that
+ * systems can walk just the bodies that have the component.
+ * Each component is found from its body's ID (see body_get_id())
+ * through a sparse index, so lookups take constant time.
+ */
+typedef struct component_pool component_pool_t;
+
+/**
+ * Allocates an empty pool for components of a given kind.
+ *
+ * @param kind the kind of component the pool stores
+ * @return a pointer to the newly allocated pool
+ */
+component_pool_t *component_pool_init(const component_kind_t *kind);
+
+/**
+ * Releases the memory allocated for a pool.
+ * The bodies in the pool are not freed.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ */
+void component_pool_free(component_pool_t *pool);
+
+/**
+ * Gets the kind of component a pool stores.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @return the kind passed to component_pool_init()
+ */
+const component_kind_t *component_pool_kind(component_pool_t *pool);
+
+/**
+ * Gets the number of components in a pool.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @return the number of bodies that have the component
+ */
+size_t component_pool_size(component_pool_t *pool);
+
+/**
+ * Gets the packed array of components in a pool.
+ * Component i is kind->size * i bytes from the start.
+ * The array moves when components are added or removed.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @return the first component in the pool
+ */
+void *component_pool_data(component_pool_t *pool);
+
+/**
+ * Gets the bodies that own the components in a pool,
+ * in the same order as component_pool_data().
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @return the first body in the pool
+ */
+body_t **component_pool_bodies(component_pool_t *pool);
+
+/**
+ * Gives a body a component, filled with zeros.
+ * If the body already has one, returns the existing component.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @param body the body to add the component to, which must have an ID
+ * @return the body's component, valid until the pool next changes size
+ */
+void *component_pool_add(component_pool_t *pool, body_t *body);
+
+/**
+ * Gets the component of a body.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @param body the body whose component to get
+ * @return the body's component, or NULL if the body does not have one
+ */
+void *component_pool_get(component_pool_t *pool, body_t *body);
+
+/**
+ * Takes the component away from every body for which keep() returns false,
+ * and from every component the kind's own keep() rejects,
+ * in a single pass that keeps the remaining components in order.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @param keep a function that returns true for the bodies to keep
+ */
+void component_pool_filter(component_pool_t *pool, keep_func_t keep);
+
+/**
+ * Replaces the contents of a pool.
+ *
+ * @param pool a pointer to a pool returned from component_pool_init()
+ * @param bodies the bodies that should have the component, or NULL if count is 0
+ * @param data the packed components of those bodies, or NULL if count is 0
+ * @param count the number of bodies
+ */
+void component_pool_set(component_pool_t *pool, body_t **bodies, const void *data,
+                        size_t count);
+
+#endif // #ifndef __COMPONENT_H__
@@ -8,8 +8,9 @@
  * Spawns a random enemy beyond the right side of the screen.
  * 
  * @param scene a pointer to a scene
- * @param MIN the coordinates of the bottom-left corner of the screen
- * @param MAX the coordinate of the top-right corner of the screen
+ * @param MIN the scene coordinates of the bottom-left corner of the screen,
+ *   which move with the camera (see scene_get_camera())
+ * @param MAX the scene coordinates of the top-right corner of the screen
  */
 void enemy_spawn_random(scene_t *scene, vector_t MIN, vector_t MAX);
 
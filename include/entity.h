@@ -2,109 +2,123 @@
 #define __ENTITY_H__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include "scene.h"
 
 /**
- * A number of tags that a body may have if it is an entity in a game.
+ * The type of an entity in a game, stored as the type of its body
+ * (see scene_set_type()). Type names are interned to small numbers, so
+ * comparing types is an integer comparison, and the scene keeps an index
+ * of the bodies of each type (see scene_get_bodies_of_type()).
+ * Everything else about an entity is kept in components (see below),
+ * so systems only visit the entities they care about.
  */
-typedef struct entity entity_t;
+typedef size_t entity_type_t;
 
 /**
- * Child of entity: additional tags that a player may have.
+ * The entity types used by the game, interned in this order on startup.
+ * Type 0 is left for bodies that are not entities (e.g. text).
  */
-typedef struct player_entity player_entity_t;
+enum {
+    ENTITY_NONE,
+    ENTITY_BACKGROUND,
+    ENTITY_PLAYER,
+    ENTITY_TERRAIN,
+    ENTITY_PLATFORM,
+    ENTITY_BULLET,
+    ENTITY_ENEMY,
+    ENTITY_POWERUP,
+    ENTITY_COIN
+};
 
 /**
- * Initializes an entity.
- * 
- * @param entity_type type of entity: PLAYER, BULLET, ENEMY, TERRAIN, POWERUP
- * @param scrollable whether or not the entity should scroll with the screen
- * @param fallable whether or not the entity experiences gravity
+ * The powerups a player can have active.
  */
-entity_t *entity_init(char *entity_type, bool scrollable, bool fallable);
+typedef enum {
+    POWERUP_NONE,
+    POWERUP_SLOW,
+    POWERUP_JUMP,
+    POWERUP_MAGNET
+} powerup_t;
 
 /**
- * Initializes an entity.
- * 
- * @param entity_type type of entity: PLAYER, BULLET, ENEMY, TERRAIN, POWERUP
- * @param scrollable whether or not the entity should scroll with the screen
- * @param fallable whether or not the entity experiences gravity
+ * Component of the player: the state that only the player has.
  */
-player_entity_t *player_entity_init(char *entity_type, bool scrollable, bool fallable);
+typedef struct {
+    powerup_t active_powerup;
+    int num_coins;
+} player_state_t;
 
-/**
- * Frees an entity.
- */
-void entity_free(entity_t *entity);
-
-/**
- * Returns the entity type of an entity.
- * 
- * @param entity a pointer to an entity
- * @return entity_type of the entity
- */
-char *entity_get_type(entity_t *entity);
+extern const component_kind_t PLAYER_STATE;
 
 /**
- * Returns the state of scrollable of an entity.
- * 
- * @param entity a pointer to an entity
- * @return a boolean representing whether scrollable is true or false.
+ * Gets the entity type with a given name, interning the name
+ * as a new type if it has not been seen before.
+ * Types are shared by every scene in the process, so this may be called
+ * from threads ticking different scenes.
+ *
+ * @param name the name of the type, e.g. "ENEMY"; must outlive the program
+ * @return the entity type with that name
  */
-bool entity_get_scrollable(entity_t *entity);
+entity_type_t entity_type_intern(const char *name);
 
 /**
- * Returns the state of fallable of an entity.
- * 
- * @param entity a pointer to an entity
- * @return a boolean representing whether fallable is true or false.
+ * Gets the name of an entity type.
+ *
+ * @param type an entity type returned from entity_type_intern()
+ * @return the name of the type
  */
-bool entity_get_fallable(entity_t *entity);
+const char *entity_type_name(entity_type_t type);
 
 /**
- * Returns the state of is_scrolling of an entity.
- * 
- * @param entity a pointer to an entity
- * @return a boolean representing whether is_scrolling is true or false.
+ * Adds the body of an entity to a scene with a given entity type.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body the body of the entity
+ * @param type the type of the entity, e.g. ENTITY_ENEMY
  */
-bool entity_is_scrolling(entity_t *entity);
+void entity_add(scene_t *scene, body_t *body, entity_type_t type);
 
 /**
- * Sets is_scrolling of an entity to true.
+ * Gives an entity the state of a player, with no powerup active.
  * 
- * @param entity a pointer to an entity
+ * @param scene the scene the entity's body has been added to
+ * @param body the body of the entity
+ * @return the player state of the entity
  */
-void entity_set_scrolling(entity_t *entity);
+player_state_t *entity_add_player_state(scene_t *scene, body_t *body);
 
 /**
- * Gets is_colliding of a player entity.
+ * Gets the player state of an entity.
  * 
- * @param entity a pointer to a player entity
- * @return the boolean value of is_colliding of the entity
+ * @param scene the scene the entity's body has been added to
+ * @param body the body of the entity
+ * @return the player state of the entity, or NULL if it is not a player
  */
-bool entity_get_colliding(player_entity_t *entity);
+player_state_t *entity_get_player_state(scene_t *scene, body_t *body);
 
 /**
- * Sets is_colliding of a player entity.
+ * Gets the active powerup of a player.
  * 
- * @param entity a pointer to an entity
- * @param value the new value of is_colliding
+ * @param state a pointer to a player state
+ * @return the active powerup, or POWERUP_NONE
  */
-void entity_set_colliding(player_entity_t *entity, bool value);
+powerup_t entity_get_powerup(player_state_t *state);
 
 /**
- * Gets the active powerup of a player entity.
+ * Sets the active powerup of a player.
  * 
- * @param entity a pointer to a player entity
- * @return the char * value of the player entity
+ * @param state a pointer to a player state
+ * @param new_powerup the new value of active_powerup
  */
-char *entity_get_powerup(player_entity_t *entity);
+void entity_set_powerup(player_state_t *state, powerup_t new_powerup);
 
 /**
- * Sets the active powerup of a player entity.
- * 
- * @param entity a pointer to a player entity
- * @param new_powerup the new value of active_powerup
+ * Gets the name of a powerup, for display.
+ *
+ * @param powerup a powerup
+ * @return the name of the powerup, e.g. "MAGNET", or "NONE"
  */
-void entity_set_powerup(player_entity_t *entity, char *new_powerup);
+const char *entity_powerup_name(powerup_t powerup);
 
 #endif // #ifndef __ENTITY_H__
@@ -1,6 +1,7 @@
 #ifndef __FORCES_H__
 #define __FORCES_H__
 
+#include <stdint.h>
 #include "scene.h"
 
 /**
@@ -23,7 +24,19 @@ double calculate_reduced_mass(body_t *body1, body_t *body2);
 typedef void (*collision_handler_t)
     (body_t *body1, body_t *body2, vector_t axis, void *aux);
 
-typedef void (*normal_handler_t) (void *aux);
+/**
+ * A function called when two bodies start touching, keep touching,
+ * or stop touching.
+ * @param body1 the first body passed to create_contact_collision()
+ * @param body2 the second body passed to create_contact_collision()
+ * @param event whether the contact is starting, continuing or ending
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in,
+ *   or VEC_ZERO if event is CONTACT_EXIT
+ * @param aux the auxiliary value passed to create_contact_collision()
+ */
+typedef void (*contact_handler_t)
+    (body_t *body1, body_t *body2, contact_event_t event, vector_t axis, void *aux);
 
 /**
  * Adds a force creator to a scene that applies gravity between two bodies.
@@ -37,50 +50,92 @@ typedef void (*normal_handler_t) (void *aux);
  * @param G the gravitational proportionality constant
  * @param body1 the first body
  * @param body2 the second body
- * @param freer the function that frees G
  */
-void create_newtonian_gravity(scene_t *scene, void *G, body_t *body1, body_t *body2,
-                              free_func_t freer);
+void create_newtonian_gravity(scene_t *scene, double G, body_t *body1, body_t *body2);
+
+/**
+ * Adds a force creator to a scene that pulls one body towards another
+ * with Newtonian gravity, without pulling the other body back.
+ * Like create_newtonian_gravity(), no force is applied when the bodies
+ * are very close.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param body1 the body that is attracted
+ * @param body2 the body it is attracted to
+ */
+void create_one_way_gravity(scene_t *scene, double G, body_t *body1, body_t *body2);
+
+/**
+ * Adds a force creator to a scene that applies newtonian gravity between
+ * every pair of bodies of a given type, like calling create_newtonian_gravity()
+ * on each pair. Instead of one force per pair, the field approximates the pull
+ * of distant groups of bodies with the Barnes–Hut method (see quadtree_gravity()),
+ * which takes O(n log n) time per tick for n bodies.
+ * Bodies that gain the type later are pulled too, and removed bodies drop out.
+ * The bodies must have finite masses.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the opening angle; 0 computes every pair exactly,
+ *   and around 0.5 is usually within a few percent of it
+ * @param type the type of the bodies (see scene_set_type())
+ */
+void create_gravity_field(scene_t *scene, double G, double theta, size_t type);
 
 /**
  * Adds a force creator to a scene that acts like a spring between two bodies.
  * The force creator will be called each tick
  * to compute the Hooke's-Law spring force between the bodies.
  * See https://en.wikipedia.org/wiki/Hooke%27s_law.
+ * The spring is integrated implicitly, so it is stable for any k and tick length.
  *
  * @param scene the scene containing the bodies
  * @param k the Hooke's constant for the spring
  * @param body1 the first body
  * @param body2 the second body
- * @param freer the function that frees k
  */
-void create_spring(scene_t *scene, void *k, body_t *body1, body_t *body2,
-                   free_func_t freer);
+void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2);
 
 /**
  * Adds a force creator to a scene that applies a drag force on a body.
  * The force creator will be called each tick
  * to compute the drag force on the body proportional to its velocity.
  * The force points opposite the body's velocity.
+ * The drag is integrated exactly, so it is stable for any gamma and tick length.
  *
  * @param scene the scene containing the bodies
  * @param gamma the proportionality constant between force and velocity
  *   (higher gamma means more drag)
  * @param body the body to slow down
- * @param freer the function that frees gamma
  */
-void create_drag(scene_t *scene, void *gamma, body_t *body, free_func_t freer);
+void create_drag(scene_t *scene, double gamma, body_t *body);
 
 /**
  * Adds a force creator to a scene that applies a constant force on a body.
  * The force creator will be called each tick.
  *
  * @param scene the scene containing the bodies
- * @param a the acceleration
+ * @param A the acceleration
  * @param body the body to apply the force to
- * @param freer the function that frees a
  */
-void create_constant_force(scene_t *scene, void *A, body_t *body, free_func_t freer);
+void create_constant_force(scene_t *scene, vector_t A, body_t *body);
+
+/**
+ * Adds a force creator to a scene that gives a constant acceleration
+ * (e.g. gravity) to every body of some types in a region.
+ * Unlike create_constant_force(), the field is a single force for the scene:
+ * bodies that gain one of the types later are accelerated too,
+ * without adding a force of their own. Bodies with an infinite mass are not moved.
+ *
+ * @param scene the scene containing the bodies
+ * @param A the acceleration
+ * @param region the field acts on bodies whose centroid is in this box,
+ *   or AABB_EVERYWHERE for a uniform field
+ * @param types the types of the bodies to accelerate (see scene_set_type()),
+ *   with bit t set for each type t from 1 to 63, or ALL_TYPES
+ */
+void create_force_field(scene_t *scene, vector_t A, aabb_t region, uint64_t types);
 
 /**
  * Adds a force creator to a scene that calls a given collision handler
@@ -89,6 +144,9 @@ void create_constant_force(scene_t *scene, void *A, body_t *body, free_func_t fr
  * allowing different things to happen on a collision.
  * The handler is passed the bodies, the collision axis, and an auxiliary value.
  * It should only be called once while the bodies are still colliding.
+ * Whether they were colliding is kept in the scene's pair cache
+ * (see scene_get_pair_cache()), which holds one contact per pair of bodies,
+ * so each pair should be given only one collision.
  *
  * @param scene the scene containing the bodies
  * @param body1 the first body
@@ -106,6 +164,26 @@ void create_collision(
     free_func_t freer
 );
 
+/**
+ * Like create_collision(), but calls the handler on every tick the bodies
+ * are touching, and once more when they stop touching (see contact_event_t).
+ *
+ * @param scene the scene containing the bodies
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param handler a function to call whenever the contact between the bodies changes
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void create_contact_collision(
+    scene_t *scene,
+    body_t *body1,
+    body_t *body2,
+    contact_handler_t handler,
+    void *aux,
+    free_func_t freer
+);
+
 /**
  * Adds a force creator to a scene that destroys two bodies when they collide.
  * The bodies should be destroyed by calling body_remove().
@@ -153,23 +231,4 @@ void create_physics_collision(
     body_t *body2
 );
 
-/**
- * Adds a force creator to a scene that acts as a normal force when the
- * player collides with it. For terrain bodies, the player collides with the
- * side walls and bottom of the hitbox. For platforms, the player lands on
- * top of the platform, but experiences no forces when hitting the platform from
- * the side or bottom.
- * 
- * @param scene the scene to add the force to
- * @param grav a vector describing the gravity of the scene
- * @param body1 the body of the player
- * @param body2 the body of the terrain
- */
-void create_normal_collision(
-    scene_t *scene,
-    vector_t grav,
-    body_t *body1,
-    body_t *body2
-);
-
 #endif // #ifndef __FORCES_H__
@@ -0,0 +1,74 @@
+#ifndef __JOBS_H__
+#define __JOBS_H__
+
+#include <stddef.h>
+
+/**
+ * A pool of worker threads that split loops into chunks and run them in parallel.
+ * Each thread starts with its own contiguous run of chunks
+ * and steals chunks from the other threads once its own run is used up.
+ * On platforms without pthreads, the pool runs every chunk on the calling thread.
+ */
+typedef struct job_pool job_pool_t;
+
+/**
+ * A function that runs one chunk of a parallel loop.
+ *
+ * @param aux the auxiliary value passed to job_pool_parallel_for()
+ * @param start the first index in the chunk
+ * @param end one past the last index in the chunk
+ * @param chunk the number of the chunk, counting up from 0 in index order
+ */
+typedef void (*job_func_t)(void *aux, size_t start, size_t end, size_t chunk);
+
+/**
+ * Allocates a job pool and starts its worker threads.
+ * The thread that calls job_pool_parallel_for() also runs chunks,
+ * so a pool with num_threads threads starts num_threads - 1 workers.
+ *
+ * @param num_threads the number of threads to run chunks on, at least 1
+ * @return a pointer to the newly allocated pool
+ */
+job_pool_t *job_pool_init(size_t num_threads);
+
+/**
+ * Stops the worker threads of a pool and releases its memory.
+ *
+ * @param pool a pointer to a pool returned from job_pool_init()
+ */
+void job_pool_free(job_pool_t *pool);
+
+/**
+ * Gets the number of threads that run chunks in a pool.
+ *
+ * @param pool a pointer to a pool returned from job_pool_init(), or NULL
+ * @return the number of threads, including the caller; 1 if pool is NULL
+ */
+size_t job_pool_threads(job_pool_t *pool);
+
+/**
+ * Gets the number of chunks a loop is split into.
+ *
+ * @param count the number of indices in the loop
+ * @param grain the number of indices in each chunk
+ * @return the number of chunks, rounding up
+ */
+size_t job_pool_chunks(size_t count, size_t grain);
+
+/**
+ * Runs func over the indices [0, count) in chunks of grain indices
+ * and returns once every chunk has finished.
+ * Chunks may run in any order and on any thread,
+ * so func must only write to data that belongs to its own chunk.
+ * If pool is NULL, every chunk runs on the calling thread, in order.
+ *
+ * @param pool a pointer to a pool returned from job_pool_init(), or NULL
+ * @param count the number of indices in the loop
+ * @param grain the number of indices in each chunk
+ * @param func the function that runs one chunk
+ * @param aux an auxiliary value to pass to func
+ */
+void job_pool_parallel_for(job_pool_t *pool, size_t count, size_t grain,
+                           job_func_t func, void *aux);
+
+#endif // #ifndef __JOBS_H__
@@ -1,6 +1,7 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 
 extern size_t DEFAULT_LIST_SIZE;
@@ -18,6 +19,12 @@ typedef struct list list_t;
  */
 typedef void (*free_func_t)(void *);
 
+/**
+ * A predicate that decides whether a list element should be kept.
+ * Examples: a function returning !body_is_removed(value)
+ */
+typedef bool (*keep_func_t)(void *);
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -46,6 +53,15 @@ void list_free(list_t *list);
  */
 size_t list_size(list_t *list);
 
+/**
+ * Gets the capacity of a list (the number of elements it has room for
+ * before it has to resize).
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @return the number of elements the list has allocated space for
+ */
+size_t list_capacity(list_t *list);
+
 /**
  * Gets the element at a given index in a list.
  * Asserts that the index is valid, given the list's current size.
@@ -77,4 +93,27 @@ void *list_remove(list_t *list, size_t index);
  */
 void list_add(list_t *list, void *value);
 
+/**
+ * Makes room for a number of elements beyond the current size of a list,
+ * so that adding them does not resize the list more than once.
+ * Like list_add(), a list that has to grow at least doubles its capacity,
+ * so reserving a few elements at a time does not copy the list each time.
+ * Asserts that the resize succeeded.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param extra the number of elements that are about to be added
+ */
+void list_reserve(list_t *list, size_t extra);
+
+/**
+ * Removes every element of a list for which keep() returns false,
+ * preserving the order of the remaining elements.
+ * Removed elements are passed to the list's freer, if it has one.
+ * Unlike repeated calls to list_remove(), this takes a single pass.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param keep a function that returns true for the elements to keep
+ */
+void list_filter(list_t *list, keep_func_t keep);
+
 #endif // #ifndef __LIST_H__
@@ -0,0 +1,94 @@
+#ifndef __MOTION_H__
+#define __MOTION_H__
+
+#include "scene.h"
+
+/**
+ * The ways a body with a motion component can move.
+ */
+typedef enum {
+    /** Swings back and forth along a line, as on a frictionless spring */
+    MOTION_OSCILLATE,
+    /** Moves with a constant acceleration */
+    MOTION_ACCELERATE,
+    /** Moves straight towards another body at a constant speed */
+    MOTION_SEEK
+} motion_type_t;
+
+/**
+ * Component of a body whose path is scripted instead of simulated.
+ * Each tick, motion_step() works out where the path takes the body
+ * from the time since the motion started, and gives the body the velocity
+ * that moves it there, so the body needs no forces of its own.
+ * Only the fields used by the motion's type are set.
+ */
+typedef struct {
+    motion_type_t type;
+    /** The number of seconds since the motion started */
+    double time;
+    /** For MOTION_OSCILLATE, the offset from the center of the swing at time 0 */
+    vector_t amplitude;
+    /** For MOTION_OSCILLATE, the angular frequency of the swing, in radians per second */
+    double frequency;
+    /** For MOTION_ACCELERATE, the velocity at time 0 */
+    vector_t velocity;
+    /** For MOTION_ACCELERATE, the acceleration */
+    vector_t acceleration;
+    /** For MOTION_SEEK, the body to move towards */
+    body_t *target;
+    /** For MOTION_SEEK, the speed to move at */
+    double speed;
+} motion_t;
+
+extern const component_kind_t MOTION;
+
+/**
+ * Makes a body in a scene swing back and forth about a center,
+ * starting from its current position at the end of the swing.
+ * A body released on a spring of constant k from rest moves this way,
+ * with a frequency of sqrt(k / mass).
+ *
+ * @param scene the scene the body has been added to
+ * @param body the body
+ * @param amplitude the body's current offset from the center of the swing
+ * @param frequency the angular frequency, in radians per second
+ */
+void motion_add_oscillation(scene_t *scene, body_t *body, vector_t amplitude,
+                            double frequency);
+
+/**
+ * Makes a body in a scene move with a constant acceleration.
+ *
+ * @param scene the scene the body has been added to
+ * @param body the body
+ * @param velocity the body's velocity now
+ * @param acceleration the acceleration
+ */
+void motion_add_acceleration(scene_t *scene, body_t *body, vector_t velocity,
+                             vector_t acceleration);
+
+/**
+ * Makes a body in a scene move straight towards another body.
+ * When the target is removed from the scene, the motion is removed with it
+ * and the body keeps its last velocity.
+ *
+ * @param scene the scene the bodies have been added to
+ * @param body the body that moves
+ * @param target the body to move towards
+ * @param speed the speed to move at
+ */
+void motion_add_seek(scene_t *scene, body_t *body, body_t *target, double speed);
+
+/**
+ * Moves the bodies of a scene that have a motion component along their paths.
+ * Called by scene_tick() once the forces of the tick have been applied
+ * and before contacts are resolved, so solvers see the velocities.
+ * The paths are relative to where the bodies are, so they survive
+ * scene_rebase().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the number of seconds the tick lasts
+ */
+void motion_step(scene_t *scene, double dt);
+
+#endif // #ifndef __MOTION_H__
@@ -0,0 +1,153 @@
+#ifndef __PAIR_CACHE_H__
+#define __PAIR_CACHE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "body.h"
+#include "collision.h"
+
+/**
+ * What happened to a pair of bodies since the last time it was tested.
+ */
+typedef enum {
+    /** The bodies were not touching and still are not */
+    CONTACT_NONE,
+    /** The bodies have just started touching */
+    CONTACT_ENTER,
+    /** The bodies were touching and still are */
+    CONTACT_STAY,
+    /** The bodies were touching and have just stopped */
+    CONTACT_EXIT
+} contact_event_t;
+
+/**
+ * The state a pair cache keeps for a pair of bodies that are near each other.
+ * contact_t is defined here instead of pair_cache.c so that collision code
+ * can read the last contact, e.g. to warm start the next test.
+ */
+typedef struct {
+    /** The body with the smaller ID */
+    body_t *body1;
+    /** The body with the larger ID */
+    body_t *body2;
+    /** Whether the bodies were touching when last tested */
+    bool touching;
+    /**
+     * The axis of the last contact, a unit vector pointing from body1 towards
+     * body2, or VEC_ZERO if the bodies have not touched since they came near.
+     */
+    vector_t axis;
+    /** How far the bodies overlapped along axis at the last contact */
+    double overlap;
+    /**
+     * The last axis found to separate the bodies,
+     * or VEC_ZERO if none has been found since they came near.
+     */
+    vector_t separating_axis;
+    /**
+     * Where the bodies touched at the last contact, if they are
+     * resolved by the contact solver (see solver.h); otherwise empty.
+     */
+    manifold_t manifold;
+    /**
+     * The total impulse the contact solver applied at each point
+     * of manifold, which it starts from on the next tick.
+     */
+    double impulses[MAX_MANIFOLD_POINTS];
+} contact_t;
+
+/**
+ * Remembers the contact state of pairs of bodies from one tick to the next,
+ * keyed by the IDs of the bodies (see body_get_id()).
+ * Only pairs whose bounding boxes overlap are stored, so the cache takes
+ * memory in proportion to the number of pairs that are near each other.
+ */
+typedef struct pair_cache pair_cache_t;
+
+/**
+ * Allocates an empty pair cache.
+ *
+ * @return a pointer to the newly allocated cache
+ */
+pair_cache_t *pair_cache_init(void);
+
+/**
+ * Releases the memory allocated for a pair cache.
+ * The bodies in the cache are not freed.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ */
+void pair_cache_free(pair_cache_t *cache);
+
+/**
+ * Gets the number of pairs in a cache.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @return the number of pairs that are near each other
+ */
+size_t pair_cache_size(pair_cache_t *cache);
+
+/**
+ * Gets the packed array of pairs in a cache.
+ * The array moves when pairs are added or removed.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @return the first pair in the cache
+ */
+const contact_t *pair_cache_contacts(pair_cache_t *cache);
+
+/**
+ * Gets the number of bytes a cache has allocated.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @return the size of the cache's storage
+ */
+size_t pair_cache_bytes(pair_cache_t *cache);
+
+/**
+ * Finds the state of a pair of bodies.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param body1 one body of the pair
+ * @param body2 the other body of the pair, in either order
+ * @return the pair's state, or NULL if the bodies are not near each other.
+ *   Valid until the cache next changes. Only the manifold and impulses
+ *   may be changed through it.
+ */
+contact_t *pair_cache_get(pair_cache_t *cache, body_t *body1, body_t *body2);
+
+/**
+ * Records the result of testing a pair of bodies for a collision.
+ * A pair that has come near is added, and one that is no longer near
+ * is removed.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param body1 the first shape passed to find_collision()
+ * @param body2 the second shape passed to find_collision()
+ * @param near whether the bounding boxes of the bodies overlap
+ * @param collision the result of find_collision(), if near is true
+ * @return what happened to the pair since it was last recorded
+ */
+contact_event_t pair_cache_update(pair_cache_t *cache, body_t *body1, body_t *body2,
+                                  bool near, collision_info_t collision);
+
+/**
+ * Removes every pair with a body for which keep() returns false,
+ * e.g. bodies that are about to be freed.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param keep a function that returns true for the bodies to keep
+ */
+void pair_cache_filter(pair_cache_t *cache, keep_func_t keep);
+
+/**
+ * Replaces the contents of a cache.
+ *
+ * @param cache a pointer to a cache returned from pair_cache_init()
+ * @param contacts the pairs to store, e.g. a copy of pair_cache_contacts(),
+ *   or NULL if count is 0
+ * @param count the number of pairs
+ */
+void pair_cache_set(pair_cache_t *cache, const contact_t *contacts, size_t count);
+
+#endif // #ifndef __PAIR_CACHE_H__
@@ -1,6 +1,7 @@
 #ifndef __POLYGON_H__
 #define __POLYGON_H__
 
+#include <stdbool.h>
 #include "list.h"
 #include "vector.h"
 
@@ -46,4 +47,14 @@ void polygon_translate(list_t *polygon, vector_t translation);
  */
 void polygon_rotate(list_t *polygon, double angle, vector_t point);
 
+/**
+ * Checks whether a polygon is a rectangle with sides parallel to the axes,
+ * so that it is the same as its bounding box (see aabb_of_polygon()).
+ *
+ * @param polygon the list of vertices that make up the polygon
+ * @return whether the polygon has 4 vertices and each of its edges
+ *   is exactly horizontal or vertical
+ */
+bool polygon_is_rect(list_t *polygon);
+
 #endif // #ifndef __POLYGON_H__
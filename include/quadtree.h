@@ -0,0 +1,61 @@
+#ifndef __QUADTREE_H__
+#define __QUADTREE_H__
+
+#include <stddef.h>
+#include "body.h"
+#include "vector.h"
+
+/**
+ * A Barnes–Hut quadtree over the centroids and masses of a set of bodies.
+ * Each node stores the total mass and center of mass of the bodies in its
+ * square, so the pull of a distant group of bodies can be approximated
+ * by the pull of a single point mass.
+ * The tree is a snapshot: it does not follow the bodies when they move,
+ * so it should be rebuilt each tick.
+ */
+typedef struct quadtree quadtree_t;
+
+/**
+ * Builds a quadtree over a set of bodies in O(n log n) time.
+ * The bodies must have finite masses.
+ *
+ * @param bodies an array of the bodies to include
+ * @param count the number of bodies in the array
+ * @return a pointer to the newly allocated tree
+ */
+quadtree_t *quadtree_init(body_t **bodies, size_t count);
+
+/**
+ * Releases the memory allocated for a quadtree.
+ * The bodies in the tree are not freed.
+ *
+ * @param tree a pointer to a tree returned from quadtree_init()
+ */
+void quadtree_free(quadtree_t *tree);
+
+/**
+ * Gets the number of nodes in a quadtree.
+ *
+ * @param tree a pointer to a tree returned from quadtree_init()
+ * @return the number of squares the tree was split into
+ */
+size_t quadtree_nodes(quadtree_t *tree);
+
+/**
+ * Approximates the newtonian gravity that the bodies in a tree exert on a body.
+ * A square of the tree that does not contain the body is treated as a point
+ * mass when its width is less than theta times its distance from the body;
+ * otherwise its children are visited. With a theta of 0, every pair is
+ * computed exactly, as create_newtonian_gravity() would.
+ *
+ * @param tree a pointer to a tree returned from quadtree_init()
+ * @param body the body to pull on; if it is in the tree, it does not pull itself
+ * @param G the gravitational proportionality constant
+ * @param theta the opening angle, e.g. 0.5; larger is faster and less accurate
+ * @param cutoff no force is applied by masses closer to the body than this
+ * @return the total force on the body
+ */
+vector_t quadtree_gravity(quadtree_t *tree, body_t *body, double G, double theta,
+                          double cutoff);
+
+#endif // #ifndef __QUADTREE_H__
@@ -1,8 +1,15 @@
 #ifndef __SCENE_H__
 #define __SCENE_H__
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "body.h"
+#include "collision.h"
+#include "component.h"
+#include "jobs.h"
 #include "list.h"
+#include "pair_cache.h"
+#include "terrain.h"
 
 /**
  * A collection of bodies and force creators.
@@ -18,6 +25,154 @@ typedef struct scene scene_t;
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * A copy of the bodies, forces and body infos of a scene at one point in time,
+ * stored in a single flat buffer (see scene_snapshot()).
+ */
+typedef struct scene_snapshot scene_snapshot_t;
+
+/**
+ * A function that returns how many bytes of a body's info to copy
+ * into a snapshot, e.g. the size of the struct the info points to.
+ */
+typedef size_t (*info_size_func_t)(void *info);
+
+/**
+ * Collects the forces computed by one chunk of a batch that is evaluated
+ * in parallel. Once every chunk is done, the scene applies the collected
+ * forces to the bodies in chunk order, so the result does not depend on
+ * which thread ran which chunk.
+ */
+typedef struct force_buffer force_buffer_t;
+
+/**
+ * A function which applies every force in a batch of forces of the same kind.
+ * The parameters of the forces are stored back to back in one array,
+ * so the function can evaluate them in a single loop.
+ * The function may be handed any contiguous part of the batch.
+ *
+ * @param scene the scene the forces belong to
+ * @param params an array of count parameter blocks (see force_kind_t)
+ * @param count the number of forces in the batch
+ * @param buffer where to add forces with force_buffer_add(),
+ *   or NULL if the batch is being evaluated on a single thread
+ */
+typedef void (*force_batch_creator_t)(scene_t *scene, void *params, size_t count,
+                                      force_buffer_t *buffer);
+
+/**
+ * A function that moves the positions stored in a batch of force parameters
+ * (e.g. a region) after the scene's origin has moved (see scene_rebase()).
+ *
+ * @param params an array of count parameter blocks (see force_kind_t)
+ * @param count the number of forces in the batch
+ * @param origin the point that became the scene's origin
+ */
+typedef void (*force_batch_rebase_t)(void *params, size_t count, vector_t origin);
+
+/**
+ * Describes a kind of force whose parameters are plain data.
+ * The scene keeps all forces of the same kind together in one batch,
+ * copies each force's parameters into the batch,
+ * and evaluates the whole batch with a single call to the creator.
+ * Kinds are compared by address, so each should be a single constant.
+ */
+typedef struct {
+    /** A name for the kind of force, for debugging */
+    const char *name;
+    /** The size in bytes of the parameters of one force */
+    size_t param_size;
+    /** The function that applies a batch of these forces */
+    force_batch_creator_t creator;
+    /**
+     * Whether creator only reads bodies and adds forces with force_buffer_add(),
+     * so that chunks of the batch can be evaluated in parallel.
+     */
+    bool parallel;
+    /**
+     * If non-NULL, a function run before creator that only reads bodies
+     * and writes to the parameters it is handed (e.g. a narrowphase test).
+     * Chunks of it may run in parallel even when creator runs on one thread.
+     */
+    force_batch_creator_t prepare;
+    /**
+     * If non-NULL, a function called on the parameters of a force
+     * when the force is removed, to release anything they point to.
+     * It must not free the parameters themselves; the batch owns them.
+     */
+    free_func_t param_freer;
+    /**
+     * If non-NULL, a function called on the whole batch when the scene
+     * is rebased, for parameters that hold positions in scene coordinates.
+     */
+    force_batch_rebase_t rebase;
+} force_kind_t;
+
+/**
+ * Counters describing what a scene holds and what it did in its last tick,
+ * for spotting a run that degrades over time (e.g. forces piling up).
+ * The counts of what the scene holds are taken when scene_get_stats()
+ * is called; the rest cover everything since the start of the last call
+ * to scene_tick().
+ */
+typedef struct {
+    /** The number of bodies in the scene */
+    size_t bodies;
+    /** The number of entries in bodies_by_type */
+    size_t num_types;
+    /** The number of bodies of each type (see scene_set_type()), indexed by type */
+    const size_t *bodies_by_type;
+    /** The number of forces in the scene, of any kind */
+    size_t forces;
+    /** The number of entries in kinds and forces_by_kind */
+    size_t num_kinds;
+    /** Each kind of force the scene has held, in the order first added */
+    const force_kind_t *const *kinds;
+    /** The number of forces of each kind in kinds */
+    const size_t *forces_by_kind;
+    /** The number of pairs of bodies in the pair cache */
+    size_t cached_pairs;
+    /** The number of pairs of shapes tested for a collision */
+    size_t narrowphase_tests;
+    /** The number of separating axes those tests projected the shapes onto */
+    size_t sat_axes;
+    /** The number of tests settled by the axis that separated the pair last time */
+    size_t sat_hint_hits;
+    /** The number of collisions whose handlers were called */
+    size_t collisions;
+    /** The number of bodies removed from the scene */
+    size_t bodies_removed;
+    /** The number of bytes the scene allocated to hold its bodies and forces */
+    size_t bytes_allocated;
+} scene_stats_t;
+
+/**
+ * Adds a force to a body from inside a force batch creator.
+ * If buffer is NULL, the force is applied to the body right away.
+ *
+ * @param buffer the buffer passed to the force batch creator
+ * @param body the body to apply the force to
+ * @param force the force vector to apply
+ */
+void force_buffer_add(force_buffer_t *buffer, body_t *body, vector_t force);
+
+/**
+ * Adds a force that varies linearly with a body's motion
+ * (see body_add_implicit_force()) from inside a force batch creator.
+ * If buffer is NULL, the force is applied to the body right away.
+ *
+ * @param buffer the buffer passed to the force batch creator
+ * @param body the body to apply the force to
+ * @param force the force at the body's current position, without damping
+ * @param damping how much the force opposes each unit of the body's velocity
+ * @param stiffness how much the force opposes each unit the body moves
+ *   relative to the reference
+ * @param reference the velocity over the tick of the point the
+ *   displacement is measured from
+ */
+void force_buffer_add_implicit(force_buffer_t *buffer, body_t *body, vector_t force,
+                               double damping, double stiffness, vector_t reference);
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -35,6 +190,187 @@ scene_t *scene_init(void);
  */
 void scene_free(scene_t *scene);
 
+/**
+ * Lets a scene split its ticks across the threads of a job pool.
+ * Parallel force batches, the prepare step of other batches, and body
+ * integration are split into chunks; everything else, including collision
+ * handlers, still runs on the calling thread in the usual order.
+ * The scene does not own the pool.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param pool a pointer to a pool returned from job_pool_init(),
+ *   or NULL to tick on the calling thread only
+ */
+void scene_set_job_pool(scene_t *scene, job_pool_t *pool);
+
+/**
+ * Sets the region that bodies with a cull margin must stay near
+ * (see body_set_cull_margin()). Each tick, after moving the bodies,
+ * the scene removes any such body whose bounding box has left the region.
+ * The region is relative to the camera (see scene_set_camera()),
+ * so it follows the view as the camera moves.
+ * The default region is AABB_EVERYWHERE, which never removes anything.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param region the kill region, e.g. the visible part of the scene
+ */
+void scene_set_kill_region(scene_t *scene, aabb_t region);
+
+/**
+ * Gets the region set with scene_set_kill_region().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the kill region of the scene
+ */
+aabb_t scene_get_kill_region(scene_t *scene);
+
+/**
+ * Moves the camera of a scene. The camera's position is the offset from
+ * the screen to the scene: a body at the camera's position is drawn where
+ * a body at the origin would be drawn without a camera (see sdl_render_scene()).
+ * A new scene's camera is at the origin and does not move.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param position the new position of the camera
+ */
+void scene_set_camera(scene_t *scene, vector_t position);
+
+/**
+ * Gets the position of the camera of a scene (see scene_set_camera()).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the camera's position
+ */
+vector_t scene_get_camera(scene_t *scene);
+
+/**
+ * Sets the velocity the camera of a scene moves at.
+ * Each tick moves the camera before checking the kill region, so a level
+ * can scroll past the screen while its bodies stay where they are.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param velocity the new velocity of the camera
+ */
+void scene_set_camera_velocity(scene_t *scene, vector_t velocity);
+
+/**
+ * Gets the velocity set with scene_set_camera_velocity().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the camera's velocity
+ */
+vector_t scene_get_camera_velocity(scene_t *scene);
+
+/**
+ * Moves the origin of a scene's coordinates to a given point, translating
+ * every body and the camera by the same amount so nothing appears to move.
+ * The terrain and the positions held by forces (see force_kind_t) move too.
+ * A camera that keeps moving in one direction should be rebased every so often,
+ * so that coordinates stay small enough to be precise.
+ * Contact points in the pair cache are not moved, since they are found again
+ * each tick. Must not be called during scene_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param origin the point to become the origin, e.g. the camera's position
+ */
+void scene_rebase(scene_t *scene, vector_t origin);
+
+/**
+ * Sets the context a scene is drawn in (e.g. an sdl_context_t),
+ * so that code adding bodies to the scene can make them drawable there.
+ * The scene does not own the context.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param context the context, or NULL if the scene is never drawn
+ */
+void scene_set_context(scene_t *scene, void *context);
+
+/**
+ * Gets the context set with scene_set_context().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's context, or NULL if none has been set
+ */
+void *scene_get_context(scene_t *scene);
+
+/**
+ * Seeds the random number generator of a scene.
+ * Each scene has its own generator, so scenes seeded the same way
+ * play out the same way, even when they run on different threads.
+ * A new scene behaves as if seeded with 1.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param seed the seed
+ */
+void scene_seed(scene_t *scene, unsigned int seed);
+
+/**
+ * Draws the next number from the random number generator of a scene.
+ * Like rand(), but the sequence belongs to the scene and is captured
+ * by scene_snapshot(). Must only be called from the thread ticking the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a pseudo-random integer between 0 and INT_MAX
+ */
+int scene_rand(scene_t *scene);
+
+/**
+ * Gets the counters of a scene (see scene_stats_t).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's counters, valid until the scene is next changed
+ */
+const scene_stats_t *scene_get_stats(scene_t *scene);
+
+/**
+ * Records the narrowphase work done by a force batch creator in the stats
+ * of the current tick. Must be called from the creator itself,
+ * not from a prepare function, which may run on another thread.
+ *
+ * @param scene the scene passed to the force batch creator
+ * @param tests the number of pairs of shapes tested for a collision
+ * @param axes the number of separating axes the tests used
+ *   (see collision_info_t)
+ * @param hint_hits the number of tests settled by a hint
+ *   (see find_collision_with_hint())
+ * @param collisions the number of collision handlers called
+ */
+void scene_count_narrowphase(scene_t *scene, size_t tests, size_t axes,
+                             size_t hint_hits, size_t collisions);
+
+/**
+ * Gets the cache that remembers which pairs of bodies in a scene are near
+ * or touching from one tick to the next. Pairs with a body that is removed
+ * from the scene are dropped from the cache along with the body's forces.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's pair cache
+ */
+pair_cache_t *scene_get_pair_cache(scene_t *scene);
+
+/**
+ * Gets the static terrain of a scene, whose spans the contact solver
+ * looks up by column (see solver_add_terrain()). Spans whose body is removed
+ * from the scene are dropped along with the body, and the terrain
+ * follows scene_rebase() and scene_restore().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's terrain
+ */
+terrain_t *scene_get_terrain(scene_t *scene);
+
+/**
+ * Resizes the body of a span of a scene's terrain so that it covers a box
+ * (see body_resize_rect()), and updates the terrain to match (see terrain_update()).
+ * The index searched by scene_query_aabb() is refit to the new box on the next query.
+ * Must not be called during a tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param span a span of the scene's terrain, e.g. one found with terrain_find()
+ * @param box the box the span's body should cover
+ */
+void scene_update_terrain(scene_t *scene, const terrain_span_t *span, aabb_t box);
+
 /**
  * Gets the number of bodies in a given scene.
  *
@@ -55,12 +391,126 @@ body_t *scene_get_body(scene_t *scene, size_t index);
 
 /**
  * Adds a body to a scene.
+ * Bodies added while the scene is ticking are recorded and join the scene
+ * at the end of the tick (see scene_tick()), so they are not ticked until
+ * the next call.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param body a pointer to the body to add to the scene
  */
 void scene_add_body(scene_t *scene, body_t *body);
 
+/**
+ * Gives a body in a scene a component of a given kind, filled with zeros.
+ * If the body already has one, returns the existing component.
+ * The component is taken away when the body is removed from the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a body that has been added to the scene
+ * @param kind the kind of component to add
+ * @return the body's component, valid until another component of the same
+ *   kind is added or a body with one is removed
+ */
+void *scene_add_component(scene_t *scene, body_t *body, const component_kind_t *kind);
+
+/**
+ * Gets the component of a given kind that a body in a scene has.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a body that has been added to the scene
+ * @param kind the kind of component to get
+ * @return the body's component, or NULL if it does not have one
+ */
+void *scene_get_component(scene_t *scene, body_t *body, const component_kind_t *kind);
+
+/**
+ * Gets the pool that holds every component of a given kind in a scene,
+ * so that a system can walk just the bodies that have the component.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kind the kind of component
+ * @return the scene's pool for that kind
+ */
+component_pool_t *scene_get_components(scene_t *scene, const component_kind_t *kind);
+
+/**
+ * Sets the type of a body in a scene (see body_get_type())
+ * and adds it to the scene's index of bodies of that type.
+ * A body's type can only be set once.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a body that has been added to the scene
+ * @param type the type of the body, e.g. an interned entity type
+ */
+void scene_set_type(scene_t *scene, body_t *body, size_t type);
+
+/**
+ * Gets the bodies of a given type in a scene, in the order they were added,
+ * so that finding them takes time proportional to their number.
+ * Use component_pool_bodies() and component_pool_size() on the result.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param type a type other than 0
+ * @return the scene's index of bodies of that type
+ */
+component_pool_t *scene_get_bodies_of_type(scene_t *scene, size_t type);
+
+/**
+ * A mask of types (with bit t set for type t) that matches every body,
+ * e.g. for create_force_field() or scene_query_aabb().
+ */
+extern const uint64_t ALL_TYPES;
+
+/**
+ * Finds the bodies of a scene whose bounding boxes overlap a box.
+ * Queries search an index of the bodies' bounding boxes (see spatial_index_t),
+ * so they take time about logarithmic in the number of bodies, and allocate
+ * nothing. The index is rebuilt on the first query after bodies are added,
+ * removed or given a type, or after a restore. After a tick or a rebase
+ * that only moved the bodies, its boxes are refit in linear time instead
+ * (see spatial_index_refit()). Bodies moved by hand since then
+ * (e.g. with body_set_centroid()) are found where they were.
+ * Queries must not run alongside each other or from a parallel force creator.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param box the box to search
+ * @param types the types of the bodies to find, with bit t set for each
+ *   type t from 0 to 63 (see scene_set_type()), or ALL_TYPES
+ * @param out an array to write the bodies found to
+ * @param capacity the length of out; the search stops once it is full
+ * @return the number of bodies written to out
+ */
+size_t scene_query_aabb(scene_t *scene, aabb_t box, uint64_t types, body_t **out,
+                        size_t capacity);
+
+/**
+ * Finds the bodies of a scene whose colliders contain a point
+ * (see find_point_in_body()), like scene_query_aabb().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param point the point, in scene coordinates
+ * @param types the types of the bodies to find, as for scene_query_aabb()
+ * @param out an array to write the bodies found to
+ * @param capacity the length of out; the search stops once it is full
+ * @return the number of bodies written to out
+ */
+size_t scene_query_point(scene_t *scene, vector_t point, uint64_t types, body_t **out,
+                         size_t capacity);
+
+/**
+ * Finds the first body of a scene that a ray enters (see find_ray_hit()),
+ * searching the same index as scene_query_aabb().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start the start of the ray
+ * @param end the end of the ray
+ * @param types the types of the bodies to hit, as for scene_query_aabb()
+ * @param hit set to the closest hit, if there is one
+ * @return whether the ray hit any body
+ */
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end, uint64_t types,
+                   ray_hit_t *hit);
+
 /**
  * @deprecated Use body_remove() instead
  *
@@ -106,10 +556,36 @@ void scene_add_bodies_force_creator(
     free_func_t freer
 );
 
+/**
+ * Adds a force of a given kind to a scene,
+ * to be evaluated with the rest of its batch every time scene_tick() is called.
+ * The parameters are copied into the batch, so they may live on the stack.
+ * Forces added while the scene is ticking (e.g. from a collision handler)
+ * are recorded and join their batch at the end of the tick (see scene_tick()).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kind the kind of force, which determines the batch it joins
+ * @param params a pointer to kind->param_size bytes of parameters
+ * @param bodies the list of bodies affected by the force, or NULL.
+ *   The force will be removed if any of these bodies are removed.
+ *   This list does not own the bodies, so its freer should be NULL.
+ */
+void scene_add_batched_force(
+    scene_t *scene,
+    const force_kind_t *kind,
+    const void *params,
+    list_t *bodies
+);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
- * and then ticking each body (see body_tick()).
+ * This requires executing all the force creators, one batch at a time,
+ * moving bodies along scripted paths (see motion_step()),
+ * resolving contacts between movers and solids (see solver_step()),
+ * and then moving the camera, ticking each body (see body_tick()) and marking
+ * those that have left the kill region for removal (see scene_set_kill_region()).
+ * Bodies and forces added during those steps are then added to the scene
+ * in the order they were added, growing each list at most once.
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
  *
@@ -118,4 +594,50 @@ void scene_add_bodies_force_creator(
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * Captures the state of a scene: the motion state and vertices of each body,
+ * a byte copy of each body's info, every component, every force
+ * with its parameters, the pair cache, the terrain, the camera, and the random
+ * number generator.
+ * Drawing information is not captured.
+ * While the snapshot exists, bodies and forces that leave the scene are kept
+ * alive (but not ticked) so the snapshot can bring them back; they are freed
+ * once every snapshot of the scene has been freed.
+ * Must not be called during scene_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param info_size returns the number of bytes to copy from a body's info,
+ *   or NULL to leave infos out of the snapshot
+ * @return a snapshot to pass to scene_restore() and scene_snapshot_free()
+ */
+scene_snapshot_t *scene_snapshot(scene_t *scene, info_size_func_t info_size);
+
+/**
+ * Puts a scene back into the state captured by a snapshot.
+ * Bodies and forces added since the snapshot leave the scene, those removed
+ * since come back, and every body's state and info is copied back in place.
+ * The snapshot can be restored any number of times.
+ * Must not be called during scene_tick().
+ *
+ * @param scene the scene the snapshot was taken of
+ * @param snapshot a pointer to a snapshot returned from scene_snapshot()
+ */
+void scene_restore(scene_t *scene, scene_snapshot_t *snapshot);
+
+/**
+ * Gets the number of bytes a snapshot takes up.
+ *
+ * @param snapshot a pointer to a snapshot returned from scene_snapshot()
+ * @return the size of the snapshot's buffer
+ */
+size_t scene_snapshot_size(scene_snapshot_t *snapshot);
+
+/**
+ * Releases the memory allocated for a snapshot. Every snapshot of a scene
+ * must be freed before the scene is.
+ *
+ * @param snapshot a pointer to a snapshot returned from scene_snapshot()
+ */
+void scene_snapshot_free(scene_snapshot_t *snapshot);
+
 #endif // #ifndef __SCENE_H__
@@ -10,6 +10,14 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
+/**
+ * Holds everything needed to draw scenes and handle input: the SDL window
+ * and renderer, the visible part of the scene, and the event handlers.
+ * A headless context (see sdl_init_headless()) has no window, so scenes that
+ * use it can be run anywhere, e.g. many at once on separate threads.
+ */
+typedef struct sdl_context sdl_context_t;
+
 /**
  * Contains all the info needed to draw a sprite, including the texture used
  * scaling of the image, and number of frames and fps animating
@@ -29,33 +37,40 @@ void text_info_free(text_info_t *info);
 /**
  * Creates the info of animated sprite .
  * 
+ * @param context the context the sprite is drawn in;
+ *   sprites of a headless context have no texture
  * @param image file link of image used to create texture 
  * @param scale the scaling of the image
  * @param frames number of frames of animation 
  * @param fps how fast the animation is
  * @return a pointer to info for a sprite
  */
-sprite_t *sprite_animated(const char *image, double scale, int frames, int fps);
+sprite_t *sprite_animated(sdl_context_t *context, const char *image, double scale,
+                          int frames, int fps);
 
 /**
  * Creates the info of unanimated sprite .
  * 
+ * @param context the context the sprite is drawn in
  * @param image file link of image used to create texture 
  * @param scale the scaling of the image
  * @param in rectangular section of image drawn
  * @return a pointer to info for a sprite
  */
-sprite_t *sprite_image(const char *image, double scale, SDL_Rect *in);
+sprite_t *sprite_image(sdl_context_t *context, const char *image, double scale,
+                       SDL_Rect *in);
 
 /**
  * Creates the info of scrolling sprite .
  * 
+ * @param context the context the sprite is drawn in
  * @param image file link of image used to create texture 
  * @param scroll speed of scrolling
  * @param in initial frame to start scroll from
  * @return a pointer to info for a sprite
  */
-sprite_t *sprite_scroll(const char *image, int scroll, SDL_Rect *in);
+sprite_t *sprite_scroll(sdl_context_t *context, const char *image, int scroll,
+                        SDL_Rect *in);
 
 /**
  * Releases the memory allocated for sprite.
@@ -140,86 +155,128 @@ typedef void (*event_handler_t)(char event, void *type, double held_time,
                               void *scene);
 
 /**
- * Initializes the SDL window and renderer.
- * Must be called once before any of the other SDL functions.
+ * Initializes SDL and creates a context with a window and renderer.
+ * Must be called before any of the other SDL functions
+ * that need a window.
+ *
+ * @param min the x and y coordinates of the bottom left of the scene
+ * @param max the x and y coordinates of the top right of the scene
+ * @return the new context
+ */
+sdl_context_t *sdl_init(vector_t min, vector_t max);
+
+/**
+ * Creates a context with no window, without initializing SDL.
+ * Drawing and showing do nothing, sprites have no texture,
+ * and sdl_is_done() never reports the window closed.
  *
  * @param min the x and y coordinates of the bottom left of the scene
  * @param max the x and y coordinates of the top right of the scene
+ * @return the new context
  */
-SDL_Window *sdl_init(vector_t min, vector_t max);
+sdl_context_t *sdl_init_headless(vector_t min, vector_t max);
+
+/**
+ * Releases a context, destroying its window and renderer if it has them.
+ *
+ * @param context a pointer returned from sdl_init() or sdl_init_headless()
+ */
+void sdl_free(sdl_context_t *context);
+
+/**
+ * Returns whether a context was created with sdl_init_headless().
+ *
+ * @param context a pointer returned from sdl_init() or sdl_init_headless()
+ * @return true if the context has no window, false otherwise
+ */
+bool sdl_is_headless(sdl_context_t *context);
 
 /**
  * Processes all SDL events and returns whether the window has been closed.
  * This function must be called in order to handle keypresses.
  *
+ * @param context the context whose window and handlers to use
+ * @param scene an aux variable passed to the handlers
  * @return true if the window was closed, false otherwise
  */
-bool sdl_is_done(void *scene);
+bool sdl_is_done(sdl_context_t *context, void *scene);
 
 /**
  * Clears the screen. Should be called before drawing polygons in each frame.
+ *
+ * @param context the context whose window to clear
  */
-void sdl_clear(void);
+void sdl_clear(sdl_context_t *context);
 
 /**
  * Draws a polygon from the given list of vertices and a color.
  *
  * @param body body associated with the sprite
  * @param color the color used to fill in the polygon
+ * @param context the context to draw in
  */
-void sdl_draw_polygon( body_t *body, rgb_color_t *color);
+void sdl_draw_polygon( body_t *body, rgb_color_t *color, sdl_context_t *context);
 
 /**
  * Draws an image from the given info about a sprite.
  *
  * @param body body associated with the sprite
  * @param sprite info needed to draw the image
+ * @param context the context to draw in
  */
-void sdl_draw_image(body_t *body, sprite_t *sprite);
+void sdl_draw_image(body_t *body, sprite_t *sprite, sdl_context_t *context);
 
 /**
  * Draws an animation from the given info about a sprite.
  *
  * @param body body associated with the sprite
  * @param sprite info needed to draw the animation
+ * @param context the context to draw in
  */
-void sdl_draw_animated( body_t *body, sprite_t *sprite);
+void sdl_draw_animated( body_t *body, sprite_t *sprite, sdl_context_t *context);
 
 /**
  * Draws an image that scrolls across the screen.
  * 
  * @param body body associated with the sprite
  * @param sprite info needed to draw the animation
+ * @param context the context to draw in
  */
-void sdl_draw_scroll(body_t *body, sprite_t *sprite);
+void sdl_draw_scroll(body_t *body, sprite_t *sprite, sdl_context_t *context);
 
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
+ *
+ * @param context the context whose window to show
  */
-void sdl_show(void);
+void sdl_show(sdl_context_t *context);
 
 /**
- * Draws all bodies in a scene.
+ * Draws all bodies in a scene, as seen from the scene's camera
+ * (see scene_set_camera()).
  * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
  * so those functions should not be called directly.
  *
+ * @param context the context to draw in
  * @param scene the scene to draw
  */
-void sdl_render_scene(scene_t *scene);
+void sdl_render_scene(sdl_context_t *context, scene_t *scene);
 
 /**
- * Draws all bodies in a scene with a text overlay.
+ * Draws all bodies in a scene, as seen from the scene's camera,
+ * with a text overlay that does not move with the camera.
  * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
  * so those functions should not be called directly.
  *
+ * @param context the context to draw in
  * @param scene the scene to draw
  * @param score_text information containing the score's text
  * @param coins_text information containing the number of coins
  * @param powerup_text information containing the current powerup
  */
-void sdl_render_scene_with_score(scene_t *scene, text_info_t *score_text,
-    text_info_t *coins_text, text_info_t *powerup_text);
+void sdl_render_scene_with_score(sdl_context_t *context, scene_t *scene,
+    text_info_t *score_text, text_info_t *coins_text, text_info_t *powerup_text);
 
 /**
  * Registers a function to be called every time a key is pressed.
@@ -240,38 +297,44 @@ void sdl_render_scene_with_score(scene_t *scene, text_info_t *score_text,
  *     }
  * }
  * int main(void) {
- *     sdl_on_key(on_key);
- *     while (!sdl_is_done());
+ *     sdl_context_t *context = sdl_init(min, max);
+ *     sdl_on_key(context, on_key);
+ *     while (!sdl_is_done(context, NULL));
  * }
  * ```
  *
+ * @param context the context whose key presses to handle
  * @param handler the function to call with each key press
  */
-void sdl_on_key(event_handler_t handler);
+void sdl_on_key(sdl_context_t *context, event_handler_t handler);
 
 
 /**
  * Registers a function to be called every time a mouse button is pressed.
  * Overwrites any existing handler.
  *
+ * @param context the context whose button presses to handle
  * @param handler the function to call with each button press
  */
-void sdl_on_click(event_handler_t handler);
+void sdl_on_click(sdl_context_t *context, event_handler_t handler);
 
 /**
- * Gets the current position of the mouse
+ * Gets the current position of the mouse on the screen,
+ * which does not account for the camera of the scene being drawn.
  *
+ * @param context the context whose window the mouse is in
  * @return vector_t of the mouse position
  */
-vector_t sdl_mouse_pos();    
+vector_t sdl_mouse_pos(sdl_context_t *context);    
 
 /**
  * Gets the amount of time that has passed since the last time
- * this function was called, in seconds.
+ * this function was called with the same context, in seconds.
  *
+ * @param context the context to time
  * @return the number of seconds that have elapsed
  */
-double time_since_last_tick(void);
+double time_since_last_tick(sdl_context_t *context);
 
 /**
  * Initializes a text_info_t of standard text with the given parameters.
@@ -308,16 +371,18 @@ text_info_t *outlined_text_info_init(char *text, const char *font,
  * 
  * @param body an unused body
  * @param info a pointer returned from text_info_init or outlined_text_info_init
+ * @param context the context to draw in
  */
-void sdl_draw_text(body_t *body, text_info_t *info);
+void sdl_draw_text(body_t *body, text_info_t *info, sdl_context_t *context);
 
 /**
  * Draws text with an outline.
  * 
  * @param body an unused body
  * @param info a pointer returned from outlined_text_info_init
+ * @param context the context to draw in
  */
-void sdl_draw_outlined_text(body_t *body, text_info_t *info);
+void sdl_draw_outlined_text(body_t *body, text_info_t *info, sdl_context_t *context);
 
 /**
  * Gives the width of the text that would be drawn.
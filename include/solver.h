@@ -0,0 +1,94 @@
+#ifndef __SOLVER_H__
+#define __SOLVER_H__
+
+#include <stdbool.h>
+#include "scene.h"
+
+/**
+ * Component of a body that movers rest on and cannot pass through,
+ * e.g. terrain. Contacts never move a solid, as if its mass were infinite,
+ * but it may have a velocity of its own (e.g. scrolling with the screen).
+ */
+typedef struct {
+    /** Whether movers may pass up through the solid and only land on its top */
+    bool one_way;
+} solid_t;
+
+/**
+ * Component of a body that the contact solver keeps out of solids.
+ */
+typedef struct {
+    /** Whether the body was standing on a solid at the end of the last tick */
+    bool grounded;
+    /**
+     * The body's bounding box when the terrain was last searched for its
+     * contacts, in the terrain's coordinates (see terrain_local_box()),
+     * so spans it has just left are dropped from the pair cache
+     */
+    aabb_t terrain_box;
+} mover_t;
+
+extern const component_kind_t SOLID;
+extern const component_kind_t MOVER;
+
+/**
+ * Makes a body in a scene a solid (see solid_t).
+ *
+ * @param scene the scene the body has been added to
+ * @param body the body
+ * @param one_way whether movers only collide with the top of the solid
+ *   when landing on it from above, as on a platform
+ */
+void solver_add_solid(scene_t *scene, body_t *body, bool one_way);
+
+/**
+ * Makes a body in a scene part of the scene's terrain (see scene_get_terrain()):
+ * a solid that movers find by looking up the terrain's columns, rather than
+ * by testing every solid. The body must be an axis-aligned rectangle
+ * that never moves (see terrain_add()).
+ *
+ * @param scene the scene the body has been added to
+ * @param body the body
+ * @param one_way whether movers only collide with the top of the body
+ *   when landing on it from above, as on a platform
+ */
+void solver_add_terrain(scene_t *scene, body_t *body, bool one_way);
+
+/**
+ * Makes a body in a scene a mover (see mover_t). The body must have a finite mass.
+ * A mover and a solid should not also have a collision between them
+ * (see create_collision()), since both keep their contact in the pair cache.
+ *
+ * @param scene the scene the body has been added to
+ * @param body the body
+ */
+void solver_add_mover(scene_t *scene, body_t *body);
+
+/**
+ * Gets whether a mover is standing on a solid.
+ *
+ * @param scene the scene the body has been added to
+ * @param body the body
+ * @return whether the body touched the top of a solid in the last tick,
+ *   or false if it is not a mover
+ */
+bool solver_is_grounded(scene_t *scene, body_t *body);
+
+/**
+ * Resolves the contacts between the movers and the solids and terrain of a scene.
+ * Called by scene_tick() once the forces of the tick have been applied
+ * and before the bodies move.
+ *
+ * Each touching pair gets a manifold of up to two contact points
+ * (see find_manifold()), kept in the scene's pair cache from one tick to
+ * the next. The solver starts from the impulses that held each point last
+ * tick, then applies sequential impulses until no mover is moving into a solid,
+ * so a resting mover is held by the same impulse every tick and does not jitter.
+ * Finally it pushes movers out of any overlap beyond a small slop.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the number of seconds the tick lasts
+ */
+void solver_step(scene_t *scene, double dt);
+
+#endif // #ifndef __SOLVER_H__
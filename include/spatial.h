@@ -0,0 +1,106 @@
+#ifndef __SPATIAL_H__
+#define __SPATIAL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "aabb.h"
+#include "body.h"
+#include "collision.h"
+#include "vector.h"
+
+/**
+ * A bounding volume hierarchy over the bounding boxes of a set of bodies,
+ * for finding the bodies in a region without testing every one.
+ * Each node stores the box around its bodies and the types among them,
+ * so queries skip whole groups of bodies that are too far away
+ * or of the wrong type.
+ * Like a quadtree_t, the index is a snapshot: it does not follow the bodies
+ * when they move, so it should be refit (or rebuilt) once they have.
+ */
+typedef struct spatial_index spatial_index_t;
+
+/**
+ * Allocates an empty spatial index.
+ *
+ * @return a pointer to the newly allocated index
+ */
+spatial_index_t *spatial_index_init(void);
+
+/**
+ * Releases the memory allocated for a spatial index.
+ * The bodies in the index are not freed.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ */
+void spatial_index_free(spatial_index_t *index);
+
+/**
+ * Rebuilds a spatial index over a set of bodies in O(n log n) time,
+ * reusing the memory of the last build. Removed bodies are left out.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param bodies an array of the bodies to include
+ * @param count the number of bodies in the array
+ */
+void spatial_index_build(spatial_index_t *index, body_t **bodies, size_t count);
+
+/**
+ * Updates the boxes of a spatial index to where its bodies are now,
+ * in O(n) time, keeping the tree from the last build.
+ * The bodies must all still exist and keep their types; the index should
+ * be rebuilt instead when bodies are added or removed. The tree gets looser
+ * the further the bodies move from where they were when it was built,
+ * which slows queries down but keeps their results exact.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param bodies the array of bodies the index was last built over,
+ *   in the same order
+ * @param count the number of bodies in the array
+ */
+void spatial_index_refit(spatial_index_t *index, body_t **bodies, size_t count);
+
+/**
+ * Finds the bodies in a spatial index whose bounding boxes overlap a box.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param box the box to search
+ * @param types the types of the bodies to find, with bit t set for each
+ *   type t from 0 to 63 (see body_get_type()), or ALL_TYPES
+ * @param out an array to write the bodies found to
+ * @param capacity the length of out; the search stops once it is full
+ * @return the number of bodies written to out
+ */
+size_t spatial_index_query_aabb(spatial_index_t *index, aabb_t box, uint64_t types,
+                                body_t **out, size_t capacity);
+
+/**
+ * Finds the bodies in a spatial index whose colliders contain a point
+ * (see find_point_in_body()).
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param point the point
+ * @param types the types of the bodies to find, as for spatial_index_query_aabb()
+ * @param out an array to write the bodies found to
+ * @param capacity the length of out; the search stops once it is full
+ * @return the number of bodies written to out
+ */
+size_t spatial_index_query_point(spatial_index_t *index, vector_t point, uint64_t types,
+                                 body_t **out, size_t capacity);
+
+/**
+ * Finds the first body in a spatial index that a ray enters (see find_ray_hit()).
+ * Subtrees whose boxes the ray reaches only after the closest hit so far
+ * are skipped.
+ *
+ * @param index a pointer to an index returned from spatial_index_init()
+ * @param start the start of the ray
+ * @param end the end of the ray
+ * @param types the types of the bodies to hit, as for spatial_index_query_aabb()
+ * @param hit set to the closest hit, if there is one
+ * @return whether the ray hit any body
+ */
+bool spatial_index_raycast(spatial_index_t *index, vector_t start, vector_t end,
+                           uint64_t types, ray_hit_t *hit);
+
+#endif // #ifndef __SPATIAL_H__
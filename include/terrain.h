@@ -0,0 +1,152 @@
+#ifndef __TERRAIN_H__
+#define __TERRAIN_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "aabb.h"
+#include "body.h"
+
+/**
+ * A piece of terrain: a solid rectangle that never moves.
+ * terrain_span_t is defined here instead of terrain.c so that a scene
+ * can copy a terrain's spans into a snapshot.
+ */
+typedef struct {
+    /** The body the span was made from */
+    body_t *body;
+    /** The body's bounding box, in the terrain's coordinates (see terrain_local_box()) */
+    aabb_t box;
+    /** Whether movers may pass up through the span and only land on its top */
+    bool one_way;
+} terrain_span_t;
+
+/**
+ * The static terrain of a scene, stored as a row of columns of fixed width.
+ * Each column lists the spans (ground, walls and platforms) that cross it,
+ * so the terrain near a box is found by looking up the few columns under it
+ * instead of testing every piece. The columns are a ring covering only
+ * the stretch of the world that has terrain in it, so a scrolling level
+ * reuses them as old terrain is removed and new terrain is added ahead.
+ *
+ * Spans are kept in coordinates of their own, which scene_rebase() moves
+ * with terrain_rebase() rather than moving every span.
+ */
+typedef struct terrain terrain_t;
+
+/**
+ * Allocates an empty terrain.
+ *
+ * @return a pointer to the newly allocated terrain
+ */
+terrain_t *terrain_init(void);
+
+/**
+ * Releases the memory allocated for a terrain.
+ * The bodies in the terrain are not freed.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ */
+void terrain_free(terrain_t *terrain);
+
+/**
+ * Gets the number of spans in a terrain.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @return the number of spans
+ */
+size_t terrain_size(terrain_t *terrain);
+
+/**
+ * Gets the packed array of spans in a terrain.
+ * The array moves when spans are added or removed.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @return the spans, terrain_size() of them
+ */
+const terrain_span_t *terrain_spans(terrain_t *terrain);
+
+/**
+ * Gets the offset from scene coordinates to a terrain's coordinates,
+ * i.e. the sum of the origins passed to terrain_rebase().
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @return the offset
+ */
+vector_t terrain_get_origin(terrain_t *terrain);
+
+/**
+ * Converts a box in scene coordinates to a terrain's coordinates.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @param box the box in scene coordinates
+ * @return the box in the terrain's coordinates
+ */
+aabb_t terrain_local_box(terrain_t *terrain, aabb_t box);
+
+/**
+ * Adds a body to a terrain as a span. The body must not move afterwards,
+ * other than with the rest of the scene in scene_rebase().
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @param body the body, an axis-aligned rectangle (see body_is_rect())
+ * @param one_way whether movers only collide with the top of the span
+ */
+void terrain_add(terrain_t *terrain, body_t *body, bool one_way);
+
+/**
+ * Updates a span of a terrain after its body's rectangle has changed,
+ * e.g. with body_resize_rect(). A span that only grew is added to the
+ * columns it gained, in time proportional to their number; otherwise
+ * the columns are laid out again, in time linear in the size of the terrain.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @param span a span of the terrain, e.g. one found with terrain_find()
+ */
+void terrain_update(terrain_t *terrain, const terrain_span_t *span);
+
+/**
+ * Finds the spans of a terrain whose boxes overlap a box, looking only
+ * at the columns under the box. Each span is found once, even if it
+ * crosses several of those columns.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @param box the box to search, in the terrain's coordinates
+ * @param out an array to write the spans found to. The spans are valid
+ *   until the terrain next changes.
+ * @param capacity the length of out; the search stops once it is full
+ * @return the number of spans written to out
+ */
+size_t terrain_find(terrain_t *terrain, aabb_t box, const terrain_span_t **out,
+                    size_t capacity);
+
+/**
+ * Moves a terrain along with a scene whose origin has moved (see scene_rebase()).
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @param origin the point that became the scene's origin
+ */
+void terrain_rebase(terrain_t *terrain, vector_t origin);
+
+/**
+ * Removes every span with a body for which keep() returns false,
+ * e.g. bodies that are about to be freed.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @param keep a function that returns true for the bodies to keep
+ */
+void terrain_filter(terrain_t *terrain, keep_func_t keep);
+
+/**
+ * Replaces the contents of a terrain.
+ *
+ * @param terrain a pointer to a terrain returned from terrain_init()
+ * @param spans the spans to store, e.g. a copy of terrain_spans(),
+ *   or NULL if count is 0
+ * @param count the number of spans
+ * @param origin the offset to the terrain's coordinates the spans were
+ *   stored with (see terrain_get_origin())
+ */
+void terrain_set(terrain_t *terrain, const terrain_span_t *spans, size_t count,
+                 vector_t origin);
+
+#endif // #ifndef __TERRAIN_H__
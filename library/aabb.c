@@ -0,0 +1,31 @@
+#include <math.h>
+#include "aabb.h"
+
+const aabb_t AABB_EVERYWHERE = {{-INFINITY, -INFINITY}, {INFINITY, INFINITY}};
+
+aabb_t aabb_of_polygon(list_t *polygon) {
+    aabb_t box = {{INFINITY, INFINITY}, {-INFINITY, -INFINITY}};
+    for (size_t i = 0; i < list_size(polygon); i++) {
+        vector_t *vertex = list_get(polygon, i);
+        box.min.x = fmin(box.min.x, vertex->x);
+        box.min.y = fmin(box.min.y, vertex->y);
+        box.max.x = fmax(box.max.x, vertex->x);
+        box.max.y = fmax(box.max.y, vertex->y);
+    }
+    return box;
+}
+
+aabb_t aabb_expand(aabb_t box, double margin) {
+    return (aabb_t) {{box.min.x - margin, box.min.y - margin},
+                     {box.max.x + margin, box.max.y + margin}};
+}
+
+bool aabb_overlaps(aabb_t box1, aabb_t box2) {
+    return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x
+        && box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
+
+bool aabb_contains(aabb_t box, vector_t point) {
+    return box.min.x <= point.x && point.x <= box.max.x
+        && box.min.y <= point.y && point.y <= box.max.y;
+}
@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <assert.h>
+#include <math.h>
 #include "body.h"
 #include "polygon.h"
 
@@ -16,10 +17,25 @@ typedef struct body {
     double orientation;
     vector_t force;
     vector_t impulse;
+    //Linear terms of the forces this tick, which body_tick() integrates implicitly.
+    double damping;
+    double stiffness;
+    //Sum of each stiffness times the velocity it pulls the body along at.
+    vector_t stiffness_velocity;
+    //Whether the shape is an axis-aligned rectangle (see body_is_rect()).
+    bool rect;
+    collider_type_t collider;
+    double radius;
+    //From the centroid to one end of a capsule's segment.
+    vector_t half_segment;
     bool remove;
+    double cull_margin;
     void *info;
     free_func_t info_freer;
     free_func_t draw_freer;
+    list_t *forces;
+    size_t id;
+    size_t type;
 } body_t;
 
 body_t *body_init(list_t *shape, double mass){
@@ -41,10 +57,21 @@ body_t *body_init_with_info(list_t *shape,
     body->orientation = 0;
     body->force = VEC_ZERO;
     body->impulse = VEC_ZERO;
+    body->damping = 0;
+    body->stiffness = 0;
+    body->stiffness_velocity = VEC_ZERO;
+    body->rect = polygon_is_rect(shape);
+    body->collider = COLLIDER_POLYGON;
+    body->radius = 0;
+    body->half_segment = VEC_ZERO;
     body->remove = false;
+    body->cull_margin = INFINITY;
     body->info = info;
     body->info_freer = info_freer;
     body->draw_freer = NULL;
+    body->forces = list_init(0, NULL);
+    body->id = 0;
+    body->type = 0;
     return body;
 }
 
@@ -57,6 +84,7 @@ void body_free(body_t *body){
     if (body->draw_freer != NULL){
         body->draw_freer(body->draw_info);
     }
+    list_free(body->forces);
     free(body);
 }
 
@@ -70,6 +98,14 @@ list_t *body_get_shape(body_t *body){
     return ret_body;
 }
 
+size_t body_num_vertices(body_t *body){
+    return list_size(body->shape);
+}
+
+vector_t body_get_vertex(body_t *body, size_t index){
+    return *(vector_t *) list_get(body->shape, index);
+}
+
 vector_t body_get_centroid(body_t *body){
     return body->centroid;
 }
@@ -117,7 +153,9 @@ void body_set_velocity(body_t *body, vector_t v){
 
 void body_set_rotation(body_t *body, double angle){
     polygon_rotate(body->shape, angle-body->orientation, body->centroid);
+    body->half_segment = vec_rotate(body->half_segment, angle-body->orientation);
     body->orientation = angle;
+    body->rect = polygon_is_rect(body->shape);
 }
 
 void body_add_force(body_t *body, vector_t force){
@@ -128,15 +166,111 @@ void body_add_impulse(body_t *body, vector_t impulse){
     body->impulse = vec_add(body->impulse, impulse); 
 }
 
+void body_add_implicit_force(body_t *body, vector_t force, double damping,
+                             double stiffness, vector_t reference){
+    body->force = vec_add(body->force, force);
+    body->damping += damping;
+    body->stiffness += stiffness;
+    if (stiffness != 0) {
+        body->stiffness_velocity = vec_add(body->stiffness_velocity,
+                                           vec_multiply(stiffness, reference));
+    }
+}
+
+vector_t body_predict_velocity(body_t *body, double dt){
+    double mass = body->mass;
+    if (mass == INFINITY) {
+        return body->velocity;
+    }
+    //Damping is solved exactly: it scales the velocity by decay over the tick,
+    //and the other forces act as if for span seconds instead of dt.
+    double decay = 1;
+    double span = dt;
+    if (body->damping != 0) {
+        decay = exp(-body->damping * dt / mass);
+        span = mass * (1 - decay) / body->damping;
+    }
+    vector_t velocity = vec_add(vec_multiply(decay, body->velocity),
+                                vec_multiply(span / mass, body->force));
+    //Stiffness is solved against the position at the end of the tick,
+    //relative to where the reference velocities carry the other ends,
+    //which pulls back less the further the body would move from them.
+    double stiff = span * dt;
+    velocity = vec_multiply(1 / (mass + stiff * body->stiffness),
+                            vec_add(vec_multiply(mass, velocity),
+                                    vec_multiply(stiff, body->stiffness_velocity)));
+    return vec_add(velocity, vec_multiply(1 / mass, body->impulse));
+}
+
 void body_tick(body_t *body, double dt){
-    vector_t dv_impulse = vec_multiply(1 / body->mass, body->impulse);
-    vector_t dv_force = vec_multiply(dt / body->mass, body->force);
     vector_t old = body_get_velocity(body);
-    body_set_velocity(body, vec_add(old, vec_add(dv_impulse, dv_force)));
-    body_set_centroid(body, vec_add(body->centroid, 
-                                    vec_multiply(dt/2, vec_add(old, body->velocity))));
+    body_set_velocity(body, body_predict_velocity(body, dt));
+    vector_t step = vec_multiply(dt/2, vec_add(old, body->velocity));
+    //Bodies at rest (e.g. terrain) are not moved vertex by vertex.
+    if (step.x != 0 || step.y != 0) {
+        body_translate(body, step);
+    }
     body->force = VEC_ZERO;
     body->impulse = VEC_ZERO;
+    body->damping = 0;
+    body->stiffness = 0;
+    body->stiffness_velocity = VEC_ZERO;
+}
+
+aabb_t body_get_aabb(body_t *body){
+    if (body->collider == COLLIDER_POLYGON) {
+        return aabb_of_polygon(body->shape);
+    }
+    vector_t reach = {fabs(body->half_segment.x) + body->radius,
+                      fabs(body->half_segment.y) + body->radius};
+    return (aabb_t) {vec_subtract(body->centroid, reach), vec_add(body->centroid, reach)};
+}
+
+bool body_is_rect(body_t *body){
+    return body->rect;
+}
+
+void body_resize_rect(body_t *body, aabb_t box){
+    assert(body->rect);
+    for (size_t i = 0; i < list_size(body->shape); i++) {
+        vector_t *vertex = list_get(body->shape, i);
+        vertex->x = vertex->x < body->centroid.x ? box.min.x : box.max.x;
+        vertex->y = vertex->y < body->centroid.y ? box.min.y : box.max.y;
+    }
+    body->centroid = (vector_t) {(box.min.x + box.max.x) / 2, (box.min.y + box.max.y) / 2};
+}
+
+void body_set_circle(body_t *body, double radius){
+    body->collider = COLLIDER_CIRCLE;
+    body->radius = radius;
+    body->half_segment = VEC_ZERO;
+}
+
+void body_set_capsule(body_t *body, double length, double radius){
+    body->collider = COLLIDER_CAPSULE;
+    body->radius = radius;
+    body->half_segment = vec_rotate((vector_t) {length / 2, 0}, body->orientation);
+}
+
+collider_type_t body_get_collider(body_t *body){
+    return body->collider;
+}
+
+double body_get_radius(body_t *body){
+    return body->radius;
+}
+
+void body_get_segment(body_t *body, vector_t *start, vector_t *end){
+    *start = vec_subtract(body->centroid, body->half_segment);
+    *end = vec_add(body->centroid, body->half_segment);
+}
+
+void body_set_cull_margin(body_t *body, double margin){
+    body->cull_margin = margin;
+}
+
+double body_get_cull_margin(body_t *body){
+    return body->cull_margin;
 }
 
 void body_remove(body_t *body){
@@ -147,8 +281,91 @@ bool body_is_removed(body_t *body){
     return body->remove;
 }
 
-void body_draw(body_t *body){
+//The plain fields of a body that body_save_state() copies out.
+typedef struct body_state {
+    double mass;
+    vector_t centroid;
+    vector_t velocity;
+    double orientation;
+    vector_t force;
+    vector_t impulse;
+    double damping;
+    double stiffness;
+    vector_t stiffness_velocity;
+    collider_type_t collider;
+    double radius;
+    vector_t half_segment;
+    bool remove;
+    double cull_margin;
+    size_t type;
+    size_t num_vertices;
+} body_state_t;
+
+size_t body_state_size(body_t *body){
+    return sizeof(body_state_t) + sizeof(vector_t) * list_size(body->shape);
+}
+
+void body_save_state(body_t *body, void *buffer){
+    body_state_t *state = buffer;
+    *state = (body_state_t) {body->mass, body->centroid, body->velocity, body->orientation,
+                             body->force, body->impulse, body->damping,
+                             body->stiffness, body->stiffness_velocity,
+                             body->collider, body->radius,
+                             body->half_segment, body->remove,
+                             body->cull_margin, body->type, list_size(body->shape)};
+    vector_t *vertices = (vector_t *) (state + 1);
+    for (size_t i = 0; i < state->num_vertices; i++) {
+        vertices[i] = *(vector_t *) list_get(body->shape, i);
+    }
+}
+
+void body_load_state(body_t *body, const void *buffer){
+    const body_state_t *state = buffer;
+    assert(state->num_vertices == list_size(body->shape));
+    body->mass = state->mass;
+    body->centroid = state->centroid;
+    body->velocity = state->velocity;
+    body->orientation = state->orientation;
+    body->force = state->force;
+    body->impulse = state->impulse;
+    body->damping = state->damping;
+    body->stiffness = state->stiffness;
+    body->stiffness_velocity = state->stiffness_velocity;
+    body->collider = state->collider;
+    body->radius = state->radius;
+    body->half_segment = state->half_segment;
+    body->remove = state->remove;
+    body->cull_margin = state->cull_margin;
+    body->type = state->type;
+    const vector_t *vertices = (const vector_t *) (state + 1);
+    for (size_t i = 0; i < state->num_vertices; i++) {
+        *(vector_t *) list_get(body->shape, i) = vertices[i];
+    }
+    body->rect = polygon_is_rect(body->shape);
+}
+
+size_t body_get_id(body_t *body){
+    return body->id;
+}
+
+void body_set_id(body_t *body, size_t id){
+    body->id = id;
+}
+
+size_t body_get_type(body_t *body){
+    return body->type;
+}
+
+void body_set_type(body_t *body, size_t type){
+    body->type = type;
+}
+
+list_t *body_get_forces(body_t *body){
+    return body->forces;
+}
+
+void body_draw(body_t *body, void *context){
     if (body->drawer!= NULL){
-       body->drawer(body, body->draw_info); 
+       body->drawer(body, body->draw_info, context); 
     }
 }
@@ -5,18 +5,50 @@
 #include "polygon.h"
 #include <assert.h>
 
-list_t *get_axis(list_t *shape){
-    list_t *axis_list =  list_init(list_size(shape), free);
-    for (size_t i = 0; i < list_size(shape); i++){
-        vector_t *axis = malloc(sizeof(vector_t));
-        vector_t tangent = vec_subtract(
-                *((vector_t *) list_get(shape, (i + 1) % list_size(shape))),
-                *((vector_t *) list_get(shape, i)));
-        tangent = vec_unit(tangent);
-        *axis = (vector_t) {tangent.y, -tangent.x};
-        list_add(axis_list, axis);
+//Polygons with up to this many vertices between them are copied to the stack.
+#define SAT_STACK_VERTICES 64
+//Number of axes each pass over the vertices projects onto.
+#define SAT_AXIS_BLOCK 4
+//Pairs with at least this many vertices between them are tested with GJK and EPA,
+//which take about linear time in the vertices where SAT takes quadratic time.
+//Below this, SAT's simpler loops win. Set from the crossover table of
+//bench/collision_bench.c (make bench): SAT is faster up to 32+32 vertices,
+//the two tie near 36+36, and GJK is faster from 40+40.
+const size_t GJK_MIN_VERTICES = 80;
+//GJK needs only a few iterations; more means rounding has it going in circles.
+const size_t GJK_MAX_ITERATIONS = 64;
+//EPA stops once the closest edge is this close to the boundary of the difference.
+const double EPA_TOLERANCE = 1e-9;
+
+//A polygon's vertices and the outward normals of its edges, copied into
+//flat arrays so that projecting reads contiguous memory.
+//Edge i runs from vertex i to vertex i + 1.
+typedef struct {
+    size_t size;
+    double *x;
+    double *y;
+    double *normal_x;
+    double *normal_y;
+} sat_shape_t;
+
+//Copies a polygon into a sat_shape_t whose arrays are in buffer,
+//which must hold 4 * list_size(shape) doubles.
+sat_shape_t sat_shape_init(list_t *shape, double *buffer){
+    size_t size = list_size(shape);
+    sat_shape_t sat = {size, buffer, buffer + size, buffer + 2 * size, buffer + 3 * size};
+    for (size_t i = 0; i < size; i++) {
+        vector_t vertex = *(vector_t *) list_get(shape, i);
+        sat.x[i] = vertex.x;
+        sat.y[i] = vertex.y;
     }
-    return axis_list;
+    for (size_t i = 0; i < size; i++) {
+        size_t next = i + 1 == size ? 0 : i + 1;
+        vector_t tangent = vec_unit((vector_t) {sat.x[next] - sat.x[i],
+                                                sat.y[next] - sat.y[i]});
+        sat.normal_x[i] = tangent.y;
+        sat.normal_y[i] = -tangent.x;
+    }
+    return sat;
 }
 
 typedef struct {
@@ -35,104 +67,916 @@ min_max_t shape_project(vector_t *axis, list_t *shape){
     return ret;
 }
 
+//Projects a shape onto a block of axes in one pass over its vertices.
+//The bounds of each projection stay in locals, which the compiler can keep
+//in (vector) registers, and are only stored once all vertices are done.
+void sat_project(sat_shape_t *shape, const double axis_x[SAT_AXIS_BLOCK],
+                 const double axis_y[SAT_AXIS_BLOCK], min_max_t out[SAT_AXIS_BLOCK]){
+    double min[SAT_AXIS_BLOCK];
+    double max[SAT_AXIS_BLOCK];
+    for (size_t j = 0; j < SAT_AXIS_BLOCK; j++) {
+        min[j] = INFINITY;
+        max[j] = -INFINITY;
+    }
+    for (size_t i = 0; i < shape->size; i++) {
+        double x = shape->x[i];
+        double y = shape->y[i];
+        for (size_t j = 0; j < SAT_AXIS_BLOCK; j++) {
+            double projection = x * axis_x[j] + y * axis_y[j];
+            min[j] = projection < min[j] ? projection : min[j];
+            max[j] = projection > max[j] ? projection : max[j];
+        }
+    }
+    for (size_t j = 0; j < SAT_AXIS_BLOCK; j++) {
+        out[j] = (min_max_t) {min[j], max[j]};
+    }
+}
+
 typedef struct {
     bool collided;
     double overlap;
     vector_t axis;
+    //Number of axes projected onto before finding a separating one.
+    size_t axes;
 } overlap_return_t;
 
-overlap_return_t overlap(list_t *axis, list_t *shape1, list_t *shape2){
-    //if there is an axis that separates the projections
+//Projects both shapes onto the edge normals of one of them, a block at a time.
+//Gives the same result as projecting onto each axis in turn and stopping
+//at the first one that separates the shapes.
+overlap_return_t overlap(sat_shape_t *axes, sat_shape_t *shape1, sat_shape_t *shape2){
     double min_overlap = INFINITY;
     vector_t min_axis = {INFINITY, INFINITY};
-    for(int i = 0; i < list_size(axis); i++){
-        min_max_t shape1_minmax = shape_project(list_get(axis,i),shape1);
-        min_max_t shape2_minmax = shape_project(list_get(axis,i),shape2);
-        //If there is an axis separating them
-        if (!((shape2_minmax.max > shape1_minmax.min) &&
-                (shape1_minmax.max > shape2_minmax.min))) {
-                return (overlap_return_t) {false, min_overlap, min_axis};
-        }
-        double overlap = fmin(shape1_minmax.max, shape2_minmax.max)
-                            - fmax(shape1_minmax.min, shape2_minmax.min);
-        if (min_overlap > overlap) {
-            assert(overlap > 0);
-            min_overlap = overlap;
-            min_axis = *((vector_t *) list_get(axis,i)); 
+    for (size_t first = 0; first < axes->size; first += SAT_AXIS_BLOCK) {
+        size_t count = fmin(SAT_AXIS_BLOCK, axes->size - first);
+        //A short last block repeats its last axis.
+        double axis_x[SAT_AXIS_BLOCK];
+        double axis_y[SAT_AXIS_BLOCK];
+        for (size_t j = 0; j < SAT_AXIS_BLOCK; j++) {
+            size_t k = first + (j < count ? j : count - 1);
+            axis_x[j] = axes->normal_x[k];
+            axis_y[j] = axes->normal_y[k];
+        }
+        min_max_t shape1_minmax[SAT_AXIS_BLOCK];
+        min_max_t shape2_minmax[SAT_AXIS_BLOCK];
+        sat_project(shape1, axis_x, axis_y, shape1_minmax);
+        sat_project(shape2, axis_x, axis_y, shape2_minmax);
+        for (size_t j = 0; j < count; j++) {
+            vector_t axis = {axis_x[j], axis_y[j]};
+            min_max_t minmax1 = shape1_minmax[j];
+            min_max_t minmax2 = shape2_minmax[j];
+            //If there is an axis separating them
+            if (!(minmax2.max > minmax1.min && minmax1.max > minmax2.min)) {
+                return (overlap_return_t) {false, min_overlap, axis, first + j + 1};
+            }
+            double overlap = fmin(minmax1.max, minmax2.max) - fmax(minmax1.min, minmax2.min);
+            if (min_overlap > overlap) {
+                assert(overlap > 0);
+                min_overlap = overlap;
+                min_axis = axis;
+                //Point the axis from shape1 towards shape2.
+                if (minmax2.min + minmax2.max < minmax1.min + minmax1.max) {
+                    min_axis = vec_negate(min_axis);
+                }
+            }
+        }
+    }
+    return (overlap_return_t) {true, min_overlap, min_axis, axes->size};
+}
+
+//Finds the bounding box of a shape's vertices.
+aabb_t sat_bounds(sat_shape_t *shape){
+    aabb_t box = {{INFINITY, INFINITY}, {-INFINITY, -INFINITY}};
+    for (size_t i = 0; i < shape->size; i++) {
+        box.min.x = fmin(box.min.x, shape->x[i]);
+        box.max.x = fmax(box.max.x, shape->x[i]);
+        box.min.y = fmin(box.min.y, shape->y[i]);
+        box.max.y = fmax(box.max.y, shape->y[i]);
+    }
+    return box;
+}
+
+//Runs the separating axis test on two copied shapes.
+collision_info_t sat_collision(sat_shape_t *shape1, sat_shape_t *shape2){
+    aabb_t box1 = sat_bounds(shape1);
+    aabb_t box2 = sat_bounds(shape2);
+    if (box1.max.x < box2.min.x || box1.max.y < box2.min.y ||
+            box2.max.x < box1.min.x || box2.max.y < box1.min.y) {
+        return (collision_info_t) {false, VEC_ZERO, 0.};
+    }
+    overlap_return_t shape1_overlap = overlap(shape1, shape1, shape2);
+    if (!shape1_overlap.collided) {
+        return (collision_info_t) {false, shape1_overlap.axis, 0, shape1_overlap.axes};
+    }
+    overlap_return_t shape2_overlap = overlap(shape2, shape1, shape2);
+    size_t axes = shape1_overlap.axes + shape2_overlap.axes;
+    if (!shape2_overlap.collided) {
+        return (collision_info_t) {false, shape2_overlap.axis, 0., axes};
+    }
+    if (shape1_overlap.overlap < shape2_overlap.overlap) {
+        return (collision_info_t) {true, vec_unit(shape1_overlap.axis),
+                                    shape1_overlap.overlap, axes};
+    }
+    return (collision_info_t) {true, vec_unit(shape2_overlap.axis),
+                                shape2_overlap.overlap, axes};
+}
+
+//Finds the point of the Minkowski difference shape1 - shape2 furthest along
+//a direction: the furthest point of shape1 minus the furthest of shape2 the other way.
+vector_t gjk_support(sat_shape_t *shape1, sat_shape_t *shape2, vector_t direction){
+    size_t best1 = 0;
+    size_t best2 = 0;
+    double max1 = -INFINITY;
+    double min2 = INFINITY;
+    for (size_t i = 0; i < shape1->size; i++) {
+        double projection = shape1->x[i] * direction.x + shape1->y[i] * direction.y;
+        if (projection > max1) {
+            max1 = projection;
+            best1 = i;
+        }
+    }
+    for (size_t i = 0; i < shape2->size; i++) {
+        double projection = shape2->x[i] * direction.x + shape2->y[i] * direction.y;
+        if (projection < min2) {
+            min2 = projection;
+            best2 = i;
+        }
+    }
+    return (vector_t) {shape1->x[best1] - shape2->x[best2],
+                       shape1->y[best1] - shape2->y[best2]};
+}
+
+//Computes (a x b) x c, a vector in the plane perpendicular to c.
+vector_t triple_product(vector_t a, vector_t b, vector_t c){
+    return vec_subtract(vec_multiply(vec_dot(a, c), b), vec_multiply(vec_dot(b, c), a));
+}
+
+//Finds the edge of the polytope closest to the origin, for EPA.
+//The polytope is counterclockwise, so each edge's outward normal is on its right.
+size_t closest_edge(vector_t *polytope, size_t size, vector_t *normal, double *distance){
+    size_t best = 0;
+    *distance = INFINITY;
+    for (size_t i = 0; i < size; i++) {
+        vector_t start = polytope[i];
+        vector_t end = polytope[i + 1 == size ? 0 : i + 1];
+        vector_t edge = vec_subtract(end, start);
+        if (edge.x == 0 && edge.y == 0) {
+            continue;
+        }
+        vector_t outward = vec_unit((vector_t) {edge.y, -edge.x});
+        double edge_distance = vec_dot(outward, start);
+        if (edge_distance < *distance) {
+            *distance = edge_distance;
+            *normal = outward;
+            best = i;
+        }
+    }
+    return best;
+}
+
+//Expands the GJK triangle around the origin into the Minkowski difference
+//until the edge closest to the origin is on its boundary. That edge's normal
+//is the collision axis and its distance from the origin is the overlap.
+collision_info_t epa_collision(sat_shape_t *shape1, sat_shape_t *shape2,
+                               vector_t simplex[3], size_t supports){
+    //The difference has at most one vertex per vertex of the shapes.
+    size_t capacity = shape1->size + shape2->size + 3;
+    vector_t stack_polytope[SAT_STACK_VERTICES + 3];
+    vector_t *polytope = stack_polytope;
+    if (capacity > SAT_STACK_VERTICES + 3) {
+        polytope = malloc(sizeof(vector_t) * capacity);
+        assert(polytope != NULL);
+    }
+    size_t size = 3;
+    polytope[0] = simplex[0];
+    //Put the triangle in counterclockwise order.
+    bool clockwise = vec_cross(vec_subtract(simplex[1], simplex[0]),
+                               vec_subtract(simplex[2], simplex[0])) < 0;
+    polytope[1] = clockwise ? simplex[2] : simplex[1];
+    polytope[2] = clockwise ? simplex[1] : simplex[2];
+
+    vector_t normal = VEC_ZERO;
+    double distance = 0;
+    while (true) {
+        size_t edge = closest_edge(polytope, size, &normal, &distance);
+        vector_t support = gjk_support(shape1, shape2, normal);
+        supports++;
+        if (vec_dot(support, normal) - distance < EPA_TOLERANCE || size == capacity) {
+            break;
+        }
+        for (size_t i = size; i > edge + 1; i--) {
+            polytope[i] = polytope[i - 1];
+        }
+        polytope[edge + 1] = support;
+        size++;
+    }
+    if (polytope != stack_polytope) {
+        free(polytope);
+    }
+    //The origin on the boundary means the shapes only touch.
+    return (collision_info_t) {distance > 0, normal, distance > 0 ? distance : 0., supports};
+}
+
+//Runs GJK on two copied shapes: builds simplices of points of the Minkowski
+//difference shape1 - shape2 until one contains the origin, which means the
+//shapes overlap, or a support point shows that none can.
+//Each support point projects both shapes onto one direction, so the
+//number of them is returned as the number of axes tested.
+collision_info_t gjk_collision(sat_shape_t *shape1, sat_shape_t *shape2){
+    aabb_t box1 = sat_bounds(shape1);
+    aabb_t box2 = sat_bounds(shape2);
+    if (box1.max.x < box2.min.x || box1.max.y < box2.min.y ||
+            box2.max.x < box1.min.x || box2.max.y < box1.min.y) {
+        return (collision_info_t) {false, VEC_ZERO, 0.};
+    }
+    //The simplex, newest point last.
+    vector_t simplex[3];
+    size_t size = 0;
+    vector_t direction = vec_subtract(vec_multiply(0.5, vec_add(box2.min, box2.max)),
+                                      vec_multiply(0.5, vec_add(box1.min, box1.max)));
+    if (direction.x == 0 && direction.y == 0) {
+        direction = (vector_t) {1, 0};
+    }
+    //Start from the side of the difference facing the origin.
+    direction = vec_negate(direction);
+    size_t supports = 0;
+    for (size_t iteration = 0; iteration < GJK_MAX_ITERATIONS; iteration++) {
+        vector_t point = gjk_support(shape1, shape2, direction);
+        supports++;
+        if (vec_dot(point, direction) <= 0) {
+            //Then no point of the difference is past the origin along direction,
+            //so shape2 is entirely ahead of shape1 along it.
+            return (collision_info_t) {false, vec_unit(direction), 0., supports};
+        }
+        simplex[size++] = point;
+        vector_t a = simplex[size - 1];
+        vector_t to_origin = vec_negate(a);
+        if (size == 1) {
+            direction = to_origin;
+        } else if (size == 2) {
+            vector_t ab = vec_subtract(simplex[0], a);
+            direction = triple_product(ab, to_origin, ab);
+            if (direction.x == 0 && direction.y == 0) {
+                //The origin is on the segment; look to one side of it.
+                direction = (vector_t) {-ab.y, ab.x};
+            }
+        } else {
+            vector_t ab = vec_subtract(simplex[1], a);
+            vector_t ac = vec_subtract(simplex[0], a);
+            if (vec_cross(ab, ac) == 0) {
+                //A flat triangle; keep its newest edge.
+                simplex[0] = simplex[1];
+                simplex[1] = a;
+                size = 2;
+                direction = (vector_t) {-ab.y, ab.x};
+                continue;
+            }
+            vector_t ab_normal = triple_product(ac, ab, ab);
+            vector_t ac_normal = triple_product(ab, ac, ac);
+            if (vec_dot(ab_normal, to_origin) > 0) {
+                simplex[0] = simplex[1];
+                simplex[1] = a;
+                size = 2;
+                direction = ab_normal;
+            } else if (vec_dot(ac_normal, to_origin) > 0) {
+                simplex[1] = a;
+                size = 2;
+                direction = ac_normal;
+            } else {
+                return epa_collision(shape1, shape2, simplex, supports);
+            }
         }
     }
-    return (overlap_return_t) {true, min_overlap, min_axis};
+    //Rounding kept GJK from settling; fall back to the separating axis test.
+    return sat_collision(shape1, shape2);
 }
 
+//A narrowphase test on two copied shapes.
+typedef collision_info_t (*shape_test_t)(sat_shape_t *shape1, sat_shape_t *shape2);
+
+//Copies two polygons into flat arrays and runs a test on them.
+collision_info_t run_shape_test(list_t *shape1, list_t *shape2, shape_test_t test){
+    size_t vertices = list_size(shape1) + list_size(shape2);
+    double stack_buffer[4 * SAT_STACK_VERTICES];
+    double *buffer = stack_buffer;
+    if (vertices > SAT_STACK_VERTICES) {
+        buffer = malloc(sizeof(double) * 4 * vertices);
+        assert(buffer != NULL);
+    }
+    sat_shape_t sat1 = sat_shape_init(shape1, buffer);
+    sat_shape_t sat2 = sat_shape_init(shape2, buffer + 4 * sat1.size);
+    collision_info_t collision = test(&sat1, &sat2);
+    if (buffer != stack_buffer) {
+        free(buffer);
+    }
+    return collision;
+}
 
 collision_info_t find_collision(list_t *shape1, list_t *shape2){
-    vector_t shape1_min = *(vector_t *) list_get(shape1,0);
-    vector_t shape1_max = *(vector_t *) list_get(shape1,0);
+    size_t vertices = list_size(shape1) + list_size(shape2);
+    return run_shape_test(shape1, shape2,
+                          vertices >= GJK_MIN_VERTICES ? gjk_collision : sat_collision);
+}
 
-    vector_t shape2_min = *(vector_t *) list_get(shape2,0);
-    vector_t shape2_max = *(vector_t *) list_get(shape2,0);
+collision_info_t find_collision_sat(list_t *shape1, list_t *shape2){
+    return run_shape_test(shape1, shape2, sat_collision);
+}
+
+collision_info_t find_collision_gjk(list_t *shape1, list_t *shape2){
+    return run_shape_test(shape1, shape2, gjk_collision);
+}
 
-    for (int i = 0; i < list_size(shape1); i++) {
-        shape1_min.x = fmin(shape1_min.x, (*(vector_t *) list_get(shape1,i)).x);
-        shape1_max.x = fmax(shape1_max.x, (*(vector_t *) list_get(shape1,i)).x);
-        shape1_min.y = fmin(shape1_min.y, (*(vector_t *) list_get(shape1,i)).y);
-        shape1_max.y = fmax(shape1_max.y, (*(vector_t *) list_get(shape1,i)).y);
+collision_info_t find_collision_with_hint(list_t *shape1, list_t *shape2, vector_t hint){
+    if (hint.x == 0 && hint.y == 0) {
+        return find_collision(shape1, shape2);
     }
-    for (int i = 0; i < list_size(shape2); i++) {
-        shape2_min.x = fmin(shape2_min.x, (*(vector_t *) list_get(shape2,i)).x);
-        shape2_max.x = fmax(shape2_max.x, (*(vector_t *) list_get(shape2,i)).x);
-        shape2_min.y = fmin(shape2_min.y, (*(vector_t *) list_get(shape2,i)).y);
-        shape2_max.y = fmax(shape2_max.y, (*(vector_t *) list_get(shape2,i)).y);
+    min_max_t shape1_minmax = shape_project(&hint, shape1);
+    min_max_t shape2_minmax = shape_project(&hint, shape2);
+    if (!((shape2_minmax.max > shape1_minmax.min) &&
+            (shape1_minmax.max > shape2_minmax.min))) {
+        return (collision_info_t) {false, hint, 0., 1, true};
     }
+    collision_info_t collision = find_collision(shape1, shape2);
+    collision.axes_tested++;
+    return collision;
+}
 
-    if (shape1_max.x < shape2_min.x || shape1_max.y < shape2_min.y ||
-                shape2_max.x < shape1_min.x || shape2_max.y < shape1_min.y) {
-                    return (collision_info_t) {false, VEC_ZERO, 0.};
-                }
-    
-    /*
-    vector_t shape1_centroid = polygon_centroid(shape1);
-    vector_t shape2_centroid = polygon_centroid(shape2);
-
-    double shape1_r = 0;
-    double shape2_r = 0;
-    for (int i = 0; i < list_size(shape1); i++) {
-        
-        shape1_r = fmax(shape1_r, 
-                vec_mag(vec_subtract(*(vector_t *) list_get(shape1,i), 
-                                        shape1_centroid)));
-    }
-    for (int i = 0; i < list_size(shape2); i++) {
-        shape2_r = fmax(shape2_r, 
-                vec_mag(vec_subtract(*(vector_t *) list_get(shape2,i), 
-                                        shape2_centroid)));
-    }
-    if (vec_mag(vec_subtract(shape1_centroid, shape2_centroid)) > 
-            shape1_r + shape2_r) {
-                return (collision_info_t) {false, VEC_ZERO};
-    }
-    */
-
-    list_t *axis1 = get_axis(shape1);
-    list_t *axis2 = get_axis(shape2);
-    overlap_return_t shape1_overlap = overlap(axis1, shape1, shape2);
-    if (!shape1_overlap.collided) {
-        return (collision_info_t) {false, VEC_ZERO, 0};
-    }
-    overlap_return_t shape2_overlap = overlap(axis2, shape1, shape2);
-    list_free(axis1);
-    list_free(axis2);
-    //if there is a separating axis from either
-    if (shape1_overlap.collided && shape2_overlap.collided) {
-        if (shape1_overlap.overlap < shape2_overlap.overlap) {
-            return (collision_info_t) {true, vec_unit(shape1_overlap.axis),
-                                        shape1_overlap.overlap};
+collision_info_t find_rect_collision(aabb_t rect1, aabb_t rect2){
+    double overlap_x = fmin(rect1.max.x, rect2.max.x) - fmax(rect1.min.x, rect2.min.x);
+    if (overlap_x <= 0) {
+        return (collision_info_t) {false, (vector_t) {1, 0}, 0., 1};
+    }
+    double overlap_y = fmin(rect1.max.y, rect2.max.y) - fmax(rect1.min.y, rect2.min.y);
+    if (overlap_y <= 0) {
+        return (collision_info_t) {false, (vector_t) {0, 1}, 0., 2};
+    }
+    //Ties go to the y axis, as they do in find_collision().
+    bool along_x = overlap_x < overlap_y;
+    //Twice the distance between the centers, which only the sign matters of.
+    double offset = along_x ? rect2.min.x + rect2.max.x - rect1.min.x - rect1.max.x
+                            : rect2.min.y + rect2.max.y - rect1.min.y - rect1.max.y;
+    double sign = offset < 0 ? -1 : 1;
+    vector_t axis = along_x ? (vector_t) {sign, 0} : (vector_t) {0, sign};
+    return (collision_info_t) {true, axis, along_x ? overlap_x : overlap_y, 2};
+}
+
+//An edge of a polygon, from start to end in counterclockwise order.
+typedef struct {
+    vector_t start;
+    vector_t end;
+} edge_t;
+
+//Finds the edge of a shape that faces a direction most squarely.
+edge_t facing_edge(list_t *shape, vector_t direction){
+    size_t size = list_size(shape);
+    size_t best = 0;
+    for (size_t i = 1; i < size; i++) {
+        if (vec_dot(*(vector_t *) list_get(shape, i), direction) >
+                vec_dot(*(vector_t *) list_get(shape, best), direction)) {
+            best = i;
+        }
+    }
+    vector_t vertex = *(vector_t *) list_get(shape, best);
+    vector_t prev = *(vector_t *) list_get(shape, (best + size - 1) % size);
+    vector_t next = *(vector_t *) list_get(shape, (best + 1) % size);
+    //Of the two edges at the furthest vertex, pick the one more perpendicular.
+    if (fabs(vec_dot(vec_unit(vec_subtract(vertex, prev)), direction)) <=
+            fabs(vec_dot(vec_unit(vec_subtract(next, vertex)), direction))) {
+        return (edge_t) {prev, vertex};
+    }
+    return (edge_t) {vertex, next};
+}
+
+//Clips a segment to the side of a line where vec_dot(normal, p) >= offset.
+//Returns the number of points left.
+size_t clip_segment(vector_t in[2], vector_t out[2], vector_t normal, double offset){
+    size_t count = 0;
+    double distance1 = vec_dot(normal, in[0]) - offset;
+    double distance2 = vec_dot(normal, in[1]) - offset;
+    if (distance1 >= 0) {
+        out[count++] = in[0];
+    }
+    if (distance2 >= 0) {
+        out[count++] = in[1];
+    }
+    if (distance1 * distance2 < 0) {
+        double t = distance1 / (distance1 - distance2);
+        out[count++] = vec_add(in[0], vec_multiply(t, vec_subtract(in[1], in[0])));
+    }
+    return count;
+}
+
+manifold_t find_manifold(list_t *shape1, list_t *shape2, vector_t axis){
+    manifold_t manifold = {0};
+    edge_t edge1 = facing_edge(shape1, axis);
+    edge_t edge2 = facing_edge(shape2, vec_negate(axis));
+    vector_t direction1 = vec_unit(vec_subtract(edge1.end, edge1.start));
+    vector_t direction2 = vec_unit(vec_subtract(edge2.end, edge2.start));
+    //The edge more perpendicular to the axis is the reference.
+    edge_t reference = edge1;
+    edge_t incident = edge2;
+    vector_t direction = direction1;
+    if (fabs(vec_dot(direction2, axis)) < fabs(vec_dot(direction1, axis))) {
+        reference = edge2;
+        incident = edge1;
+        direction = direction2;
+    }
+
+    //Clip the incident edge to the sides of the reference edge. A segment
+    //clipped down to one point is kept as a segment of zero length.
+    vector_t points[2] = {incident.start, incident.end};
+    vector_t clipped[2];
+    size_t count = clip_segment(points, clipped, direction,
+                                vec_dot(direction, reference.start));
+    if (count == 0) {
+        return manifold;
+    }
+    clipped[1] = clipped[count - 1];
+    count = clip_segment(clipped, points, vec_negate(direction),
+                         -vec_dot(direction, reference.end));
+    if (count == 0) {
+        return manifold;
+    }
+
+    //Counterclockwise order puts the outside of an edge on its right.
+    vector_t normal = {direction.y, -direction.x};
+    double face = vec_dot(normal, reference.start);
+    for (size_t i = 0; i < count; i++) {
+        double depth = face - vec_dot(normal, points[i]);
+        bool repeated = i > 0 && points[i].x == points[0].x && points[i].y == points[0].y;
+        if (depth >= 0 && !repeated) {
+            manifold.points[manifold.count] = points[i];
+            manifold.depths[manifold.count] = depth;
+            manifold.count++;
+        }
+    }
+    return manifold;
+}
+
+manifold_t find_rect_manifold(aabb_t rect1, aabb_t rect2, vector_t axis){
+    manifold_t manifold = {0};
+    bool along_x = axis.y == 0;
+    double sign = along_x ? axis.x : axis.y;
+    //How far rect2's facing side reaches into rect1, along the axis.
+    double depth = along_x ? (sign > 0 ? rect1.max.x - rect2.min.x : rect2.max.x - rect1.min.x)
+                           : (sign > 0 ? rect1.max.y - rect2.min.y : rect2.max.y - rect1.min.y);
+    //The facing side of rect2, clipped to the sides of rect1.
+    double face = along_x ? (sign > 0 ? rect2.min.x : rect2.max.x)
+                          : (sign > 0 ? rect2.min.y : rect2.max.y);
+    double low = along_x ? fmax(rect1.min.y, rect2.min.y) : fmax(rect1.min.x, rect2.min.x);
+    double high = along_x ? fmin(rect1.max.y, rect2.max.y) : fmin(rect1.max.x, rect2.max.x);
+    if (depth < 0 || low > high) {
+        return manifold;
+    }
+    double ends[2] = {low, high};
+    manifold.count = low == high ? 1 : 2;
+    for (size_t i = 0; i < manifold.count; i++) {
+        manifold.points[i] = along_x ? (vector_t) {face, ends[i]} : (vector_t) {ends[i], face};
+        manifold.depths[i] = depth;
+    }
+    return manifold;
+}
+
+//A circle or capsule: the points within radius of the segment from start to end.
+typedef struct {
+    vector_t start;
+    vector_t end;
+    double radius;
+} round_t;
+
+round_t body_round(body_t *body){
+    round_t round;
+    body_get_segment(body, &round.start, &round.end);
+    round.radius = body_get_radius(body);
+    return round;
+}
+
+min_max_t round_project(round_t *round, vector_t axis){
+    double start = vec_dot(round->start, axis);
+    double end = vec_dot(round->end, axis);
+    return (min_max_t) {fmin(start, end) - round->radius, fmax(start, end) + round->radius};
+}
+
+min_max_t sat_project_axis(sat_shape_t *shape, vector_t axis){
+    min_max_t ret = {INFINITY, -INFINITY};
+    for (size_t i = 0; i < shape->size; i++) {
+        double projection = shape->x[i] * axis.x + shape->y[i] * axis.y;
+        ret.min = fmin(ret.min, projection);
+        ret.max = fmax(ret.max, projection);
+    }
+    return ret;
+}
+
+//Copies a polygon body's shape into a sat_shape_t. Rectangles are built
+//from their bounding boxes, without copying the body's shape.
+//Returns the heap buffer the shape had to be put in, if any, for the caller to free.
+double *body_sat_shape(body_t *body, sat_shape_t *sat,
+                       double stack_buffer[4 * SAT_STACK_VERTICES]){
+    if (body_is_rect(body)) {
+        aabb_t box = body_get_aabb(body);
+        //The vertices in the order compute_rect_points() gives them.
+        double corners[16] = {box.max.x, box.min.x, box.min.x, box.max.x,
+                              box.max.y, box.max.y, box.min.y, box.min.y,
+                              0, -1, 0, 1,
+                              1, 0, -1, 0};
+        for (size_t i = 0; i < 16; i++) {
+            stack_buffer[i] = corners[i];
+        }
+        *sat = (sat_shape_t) {4, stack_buffer, stack_buffer + 4, stack_buffer + 8,
+                              stack_buffer + 12};
+        return NULL;
+    }
+    list_t *shape = body_get_shape(body);
+    double *buffer = stack_buffer;
+    if (list_size(shape) > SAT_STACK_VERTICES) {
+        buffer = malloc(sizeof(double) * 4 * list_size(shape));
+        assert(buffer != NULL);
+    }
+    *sat = sat_shape_init(shape, buffer);
+    list_free(shape);
+    return buffer != stack_buffer ? buffer : NULL;
+}
+
+double clamp(double value, double min, double max){
+    return fmin(fmax(value, min), max);
+}
+
+//Finds the closest points between two segments, p1 to q1 and p2 to q2,
+//either of which may be a single point.
+void segment_closest_points(vector_t p1, vector_t q1, vector_t p2, vector_t q2,
+                            vector_t *closest1, vector_t *closest2){
+    vector_t d1 = vec_subtract(q1, p1);
+    vector_t d2 = vec_subtract(q2, p2);
+    vector_t r = vec_subtract(p1, p2);
+    double length1 = vec_dot(d1, d1);
+    double length2 = vec_dot(d2, d2);
+    double f = vec_dot(d2, r);
+    //How far along each segment the closest points are, from 0 to 1.
+    double s = 0;
+    double t = 0;
+    if (length1 == 0) {
+        t = length2 > 0 ? clamp(f / length2, 0, 1) : 0;
+    } else {
+        double c = vec_dot(d1, r);
+        if (length2 == 0) {
+            s = clamp(-c / length1, 0, 1);
         } else {
-            return (collision_info_t) {true,
-                                    vec_unit(vec_negate(shape2_overlap.axis)),
-                                        shape2_overlap.overlap};
+            double b = vec_dot(d1, d2);
+            double denominator = length1 * length2 - b * b;
+            //Parallel segments may pick any pair of closest points.
+            s = denominator != 0 ? clamp((b * f - c * length2) / denominator, 0, 1) : 0;
+            t = (b * s + f) / length2;
+            if (t < 0) {
+                t = 0;
+                s = clamp(-c / length1, 0, 1);
+            } else if (t > 1) {
+                t = 1;
+                s = clamp((b - c) / length1, 0, 1);
+            }
+        }
+    }
+    *closest1 = vec_add(p1, vec_multiply(s, d1));
+    *closest2 = vec_add(p2, vec_multiply(t, d2));
+}
+
+//Tests two circles or capsules by the distance between their segments.
+collision_info_t round_round_collision(round_t *round1, round_t *round2){
+    vector_t closest1;
+    vector_t closest2;
+    segment_closest_points(round1->start, round1->end, round2->start, round2->end,
+                           &closest1, &closest2);
+    vector_t offset = vec_subtract(closest2, closest1);
+    double distance = vec_mag(offset);
+    if (distance == 0) {
+        //The segments cross, so push apart along the line between their middles.
+        offset = vec_subtract(vec_add(round2->start, round2->end),
+                              vec_add(round1->start, round1->end));
+    }
+    vector_t axis = offset.x != 0 || offset.y != 0 ? vec_unit(offset) : (vector_t) {0, 1};
+    double overlap = round1->radius + round2->radius - distance;
+    if (overlap <= 0) {
+        return (collision_info_t) {false, axis, 0., 1};
+    }
+    return (collision_info_t) {true, axis, overlap, 1};
+}
+
+//Finds the vertex of a polygon closest to a point.
+vector_t closest_vertex(sat_shape_t *shape, vector_t point){
+    size_t best = 0;
+    double best_distance = INFINITY;
+    for (size_t i = 0; i < shape->size; i++) {
+        double dx = shape->x[i] - point.x;
+        double dy = shape->y[i] - point.y;
+        if (dx * dx + dy * dy < best_distance) {
+            best_distance = dx * dx + dy * dy;
+            best = i;
+        }
+    }
+    return (vector_t) {shape->x[best], shape->y[best]};
+}
+
+//Tests a circle or capsule against a convex polygon with the separating axis
+//test. Besides the polygon's edge normals, the axes are the capsule's normal
+//and the directions from the segment's ends to their closest vertices,
+//which separate the rounded ends from the polygon's corners.
+collision_info_t round_polygon_collision(round_t *round, sat_shape_t *polygon){
+    vector_t extra[3];
+    size_t extras = 0;
+    vector_t along = vec_subtract(round->end, round->start);
+    if (along.x != 0 || along.y != 0) {
+        extra[extras++] = vec_unit((vector_t) {-along.y, along.x});
+    }
+    vector_t ends[2] = {round->start, round->end};
+    for (size_t i = 0; i < (extras > 0 ? 2 : 1); i++) {
+        vector_t to_vertex = vec_subtract(closest_vertex(polygon, ends[i]), ends[i]);
+        if (to_vertex.x != 0 || to_vertex.y != 0) {
+            extra[extras++] = vec_unit(to_vertex);
+        }
+    }
+    double min_overlap = INFINITY;
+    vector_t min_axis = VEC_ZERO;
+    size_t axes = polygon->size + extras;
+    for (size_t i = 0; i < axes; i++) {
+        vector_t axis = i < polygon->size
+                        ? (vector_t) {polygon->normal_x[i], polygon->normal_y[i]}
+                        : extra[i - polygon->size];
+        min_max_t minmax1 = round_project(round, axis);
+        min_max_t minmax2 = sat_project_axis(polygon, axis);
+        if (!(minmax2.max > minmax1.min && minmax1.max > minmax2.min)) {
+            return (collision_info_t) {false, axis, 0., i + 1};
+        }
+        //How far the round shape must move along the axis, either way, to clear
+        //the polygon. A small circle inside a large polygon must cross all of it.
+        double forward = minmax1.max - minmax2.min;
+        double backward = minmax2.max - minmax1.min;
+        double overlap = fmin(forward, backward);
+        if (min_overlap > overlap) {
+            min_overlap = overlap;
+            min_axis = forward <= backward ? axis : vec_negate(axis);
         }
+    }
+    return (collision_info_t) {true, min_axis, min_overlap, axes};
+}
+
+//A narrowphase test for one pair of collider types.
+//The axis it returns points from body1 towards body2.
+typedef collision_info_t (*collision_test_t)(body_t *body1, body_t *body2, vector_t hint);
+
+collision_info_t polygon_polygon_test(body_t *body1, body_t *body2, vector_t hint){
+    if (body_is_rect(body1) && body_is_rect(body2)) {
+        return find_rect_collision(body_get_aabb(body1), body_get_aabb(body2));
+    }
+    list_t *shape1 = body_get_shape(body1);
+    list_t *shape2 = body_get_shape(body2);
+    collision_info_t collision = find_collision_with_hint(shape1, shape2, hint);
+    list_free(shape1);
+    list_free(shape2);
+    return collision;
+}
+
+collision_info_t circle_circle_test(body_t *body1, body_t *body2, vector_t hint){
+    vector_t offset = vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+    double distance_squared = vec_dot(offset, offset);
+    double reach = body_get_radius(body1) + body_get_radius(body2);
+    double distance = sqrt(distance_squared);
+    vector_t axis = distance > 0 ? vec_multiply(1 / distance, offset) : (vector_t) {0, 1};
+    if (distance >= reach) {
+        return (collision_info_t) {false, axis, 0., 1};
+    }
+    return (collision_info_t) {true, axis, reach - distance, 1};
+}
+
+collision_info_t round_round_test(body_t *body1, body_t *body2, vector_t hint){
+    round_t round1 = body_round(body1);
+    round_t round2 = body_round(body2);
+    return round_round_collision(&round1, &round2);
+}
+
+collision_info_t round_polygon_test(body_t *body1, body_t *body2, vector_t hint){
+    round_t round = body_round(body1);
+    double stack_buffer[4 * SAT_STACK_VERTICES];
+    sat_shape_t polygon;
+    double *heap = body_sat_shape(body2, &polygon, stack_buffer);
+    collision_info_t collision = round_polygon_collision(&round, &polygon);
+    free(heap);
+    return collision;
+}
+
+collision_info_t polygon_round_test(body_t *body1, body_t *body2, vector_t hint){
+    collision_info_t collision = round_polygon_test(body2, body1, hint);
+    collision.axis = vec_negate(collision.axis);
+    return collision;
+}
+
+//The test for each pair of collider types, indexed by body1's type then body2's.
+//Other than against each other, circles are tested as capsules whose segment
+//is a single point.
+const collision_test_t COLLISION_TESTS[NUM_COLLIDER_TYPES][NUM_COLLIDER_TYPES] = {
+    [COLLIDER_POLYGON] = {polygon_polygon_test, polygon_round_test, polygon_round_test},
+    [COLLIDER_CIRCLE] = {round_polygon_test, circle_circle_test, round_round_test},
+    [COLLIDER_CAPSULE] = {round_polygon_test, round_round_test, round_round_test}
+};
+
+collision_info_t find_body_collision(body_t *body1, body_t *body2, vector_t hint){
+    return COLLISION_TESTS[body_get_collider(body1)][body_get_collider(body2)](
+        body1, body2, hint);
+}
+
+//Finds where a circle or capsule touches a shape it overlaps by depth along
+//an axis pointing from the round shape towards the other one.
+//The points are on the round shape's boundary; a capsule lying flat
+//against the other shape touches it at both ends.
+manifold_t round_manifold(round_t *round, vector_t axis, double depth){
+    manifold_t manifold = {0};
+    double deepest = fmax(vec_dot(round->start, axis), vec_dot(round->end, axis));
+    vector_t ends[2] = {round->start, round->end};
+    size_t count = ends[0].x == ends[1].x && ends[0].y == ends[1].y ? 1 : 2;
+    for (size_t i = 0; i < count; i++) {
+        double end_depth = depth - (deepest - vec_dot(ends[i], axis));
+        if (end_depth >= 0) {
+            manifold.points[manifold.count] = vec_add(ends[i],
+                                                      vec_multiply(round->radius, axis));
+            manifold.depths[manifold.count] = end_depth;
+            manifold.count++;
+        }
+    }
+    return manifold;
+}
+
+//Projects a body's collider onto an axis.
+min_max_t body_project(body_t *body, vector_t axis){
+    if (body_get_collider(body) != COLLIDER_POLYGON) {
+        round_t round = body_round(body);
+        return round_project(&round, axis);
+    }
+    double stack_buffer[4 * SAT_STACK_VERTICES];
+    sat_shape_t polygon;
+    double *heap = body_sat_shape(body, &polygon, stack_buffer);
+    min_max_t minmax = sat_project_axis(&polygon, axis);
+    free(heap);
+    return minmax;
+}
+
+manifold_t find_body_manifold(body_t *body1, body_t *body2, vector_t axis){
+    collider_type_t type1 = body_get_collider(body1);
+    collider_type_t type2 = body_get_collider(body2);
+    if (type1 == COLLIDER_POLYGON && type2 == COLLIDER_POLYGON) {
+        if (body_is_rect(body1) && body_is_rect(body2)) {
+            return find_rect_manifold(body_get_aabb(body1), body_get_aabb(body2), axis);
+        }
+        list_t *shape1 = body_get_shape(body1);
+        list_t *shape2 = body_get_shape(body2);
+        manifold_t manifold = find_manifold(shape1, shape2, axis);
+        list_free(shape1);
+        list_free(shape2);
+        return manifold;
+    }
+    double depth = body_project(body1, axis).max - body_project(body2, axis).min;
+    if (type1 != COLLIDER_POLYGON) {
+        round_t round = body_round(body1);
+        return round_manifold(&round, axis, depth);
+    }
+    round_t round = body_round(body2);
+    return round_manifold(&round, vec_negate(axis), depth);
+}
+
+//Finds the point of a segment closest to a point.
+vector_t segment_closest_point(vector_t start, vector_t end, vector_t point){
+    vector_t along = vec_subtract(end, start);
+    double length = vec_dot(along, along);
+    double t = length > 0 ? clamp(vec_dot(vec_subtract(point, start), along) / length, 0, 1)
+                          : 0;
+    return vec_add(start, vec_multiply(t, along));
+}
+
+bool find_point_in_body(body_t *body, vector_t point){
+    if (body_get_collider(body) != COLLIDER_POLYGON) {
+        round_t round = body_round(body);
+        vector_t offset = vec_subtract(point, segment_closest_point(round.start, round.end,
+                                                                    point));
+        return vec_dot(offset, offset) <= round.radius * round.radius;
+    }
+    //Inside a counterclockwise polygon is on the left of every edge.
+    size_t size = body_num_vertices(body);
+    for (size_t i = 0; i < size; i++) {
+        vector_t vertex = body_get_vertex(body, i);
+        vector_t edge = vec_subtract(body_get_vertex(body, i + 1 == size ? 0 : i + 1), vertex);
+        if (vec_cross(edge, vec_subtract(point, vertex)) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Finds where a ray from start along direction (with t from 0 to 1) enters
+//a circle. Returns the t, or INFINITY if it misses.
+double ray_circle(vector_t start, vector_t direction, vector_t center, double radius){
+    vector_t offset = vec_subtract(start, center);
+    double a = vec_dot(direction, direction);
+    double b = vec_dot(offset, direction);
+    double c = vec_dot(offset, offset) - radius * radius;
+    double discriminant = b * b - a * c;
+    if (a == 0 || discriminant < 0) {
+        return INFINITY;
+    }
+    double t = (-b - sqrt(discriminant)) / a;
+    return t >= 0 && t <= 1 ? t : INFINITY;
+}
+
+//Finds where a ray crosses a segment. Returns the t along the ray, or INFINITY.
+double ray_segment(vector_t start, vector_t direction, vector_t from, vector_t to){
+    vector_t edge = vec_subtract(to, from);
+    double denominator = vec_cross(direction, edge);
+    if (denominator == 0) {
+        return INFINITY;
+    }
+    vector_t offset = vec_subtract(from, start);
+    double t = vec_cross(offset, edge) / denominator;
+    double u = vec_cross(offset, direction) / denominator;
+    return t >= 0 && t <= 1 && u >= 0 && u <= 1 ? t : INFINITY;
+}
+
+//Casts a ray that starts outside a circle or capsule against its ends and sides.
+bool ray_round(round_t *round, vector_t start, vector_t direction, double *fraction,
+               vector_t *normal){
+    double best = INFINITY;
+    vector_t ends[2] = {round->start, round->end};
+    for (size_t i = 0; i < 2; i++) {
+        double t = ray_circle(start, direction, ends[i], round->radius);
+        if (t < best) {
+            best = t;
+            vector_t point = vec_add(start, vec_multiply(t, direction));
+            *normal = vec_multiply(1 / round->radius, vec_subtract(point, ends[i]));
+        }
+    }
+    vector_t along = vec_subtract(round->end, round->start);
+    if (along.x != 0 || along.y != 0) {
+        vector_t side = vec_multiply(round->radius, vec_unit((vector_t) {-along.y, along.x}));
+        for (int sign = -1; sign <= 1; sign += 2) {
+            vector_t offset = vec_multiply(sign, side);
+            double t = ray_segment(start, direction, vec_add(round->start, offset),
+                                   vec_add(round->end, offset));
+            if (t < best) {
+                best = t;
+                *normal = vec_unit(offset);
+            }
+        }
+    }
+    *fraction = best;
+    return best < INFINITY;
+}
+
+//Clips a ray to the inside of every edge of a counterclockwise polygon.
+bool ray_polygon(body_t *body, vector_t start, vector_t direction, double *fraction,
+                 vector_t *normal){
+    double enter = 0;
+    double exit = 1;
+    size_t size = body_num_vertices(body);
+    for (size_t i = 0; i < size; i++) {
+        vector_t vertex = body_get_vertex(body, i);
+        vector_t edge = vec_subtract(body_get_vertex(body, i + 1 == size ? 0 : i + 1), vertex);
+        vector_t outward = {edge.y, -edge.x};
+        double toward = vec_dot(outward, direction);
+        double distance = vec_dot(outward, vec_subtract(vertex, start));
+        if (toward == 0) {
+            //Parallel to the edge: the ray is inside it throughout, or never.
+            if (distance < 0) {
+                return false;
+            }
+            continue;
+        }
+        double t = distance / toward;
+        if (toward < 0 && t > enter) {
+            enter = t;
+            *normal = vec_unit(outward);
+        } else if (toward > 0 && t < exit) {
+            exit = t;
+        }
+        if (enter > exit) {
+            return false;
+        }
+    }
+    *fraction = enter;
+    return true;
+}
+
+bool find_ray_hit(body_t *body, vector_t start, vector_t end, ray_hit_t *hit){
+    vector_t direction = vec_subtract(end, start);
+    vector_t backwards = direction.x != 0 || direction.y != 0
+                         ? vec_unit(vec_negate(direction)) : (vector_t) {0, 1};
+    double fraction = 0;
+    vector_t normal = backwards;
+    bool found;
+    if (find_point_in_body(body, start)) {
+        found = true;
+    } else if (body_get_collider(body) != COLLIDER_POLYGON) {
+        round_t round = body_round(body);
+        found = ray_round(&round, start, direction, &fraction, &normal);
     } else {
-        return (collision_info_t) {false, VEC_ZERO, 0.};
+        found = ray_polygon(body, start, direction, &fraction, &normal);
     }
-}
\ No newline at end of file
+    if (found) {
+        *hit = (ray_hit_t) {body, vec_add(start, vec_multiply(fraction, direction)), normal,
+                            fraction};
+    }
+    return found;
+}
@@ -0,0 +1,145 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "component.h"
+
+const size_t DEFAULT_POOL_CAPACITY = 8;
+const size_t POOL_RESIZE_FACTOR = 2;
+
+typedef struct component_pool {
+    const component_kind_t *kind;
+    char *data;
+    body_t **bodies;
+    size_t size;
+    size_t capacity;
+    //Maps a body's ID to one more than the index of its component, or 0 if it has none.
+    size_t *sparse;
+    size_t sparse_capacity;
+} component_pool_t;
+
+component_pool_t *component_pool_init(const component_kind_t *kind) {
+    component_pool_t *pool = malloc(sizeof(component_pool_t));
+    assert(pool != NULL);
+    pool->kind = kind;
+    //Kinds with no data (e.g. membership of a type) still get a non-NULL array.
+    pool->data = malloc(kind->size * DEFAULT_POOL_CAPACITY + 1);
+    pool->bodies = malloc(sizeof(body_t *) * DEFAULT_POOL_CAPACITY);
+    assert(pool->data != NULL && pool->bodies != NULL);
+    pool->size = 0;
+    pool->capacity = DEFAULT_POOL_CAPACITY;
+    pool->sparse = NULL;
+    pool->sparse_capacity = 0;
+    return pool;
+}
+
+void component_pool_free(component_pool_t *pool) {
+    free(pool->data);
+    free(pool->bodies);
+    free(pool->sparse);
+    free(pool);
+}
+
+const component_kind_t *component_pool_kind(component_pool_t *pool) {
+    return pool->kind;
+}
+
+size_t component_pool_size(component_pool_t *pool) {
+    return pool->size;
+}
+
+void *component_pool_data(component_pool_t *pool) {
+    return pool->data;
+}
+
+body_t **component_pool_bodies(component_pool_t *pool) {
+    return pool->bodies;
+}
+
+//Gives the pool room for at least the given number of components.
+void pool_reserve(component_pool_t *pool, size_t capacity) {
+    if (capacity <= pool->capacity) {
+        return;
+    }
+    pool->capacity = capacity;
+    pool->data = realloc(pool->data, pool->kind->size * pool->capacity + 1);
+    pool->bodies = realloc(pool->bodies, sizeof(body_t *) * pool->capacity);
+    assert(pool->data != NULL && pool->bodies != NULL);
+}
+
+//Points a body's ID at an index in the pool, growing the sparse index if needed.
+void pool_index(component_pool_t *pool, body_t *body, size_t index) {
+    size_t id = body_get_id(body);
+    if (id >= pool->sparse_capacity) {
+        size_t capacity = pool->sparse_capacity == 0 ? DEFAULT_POOL_CAPACITY
+                                                     : pool->sparse_capacity;
+        while (id >= capacity) {
+            capacity *= POOL_RESIZE_FACTOR;
+        }
+        pool->sparse = realloc(pool->sparse, sizeof(size_t) * capacity);
+        assert(pool->sparse != NULL);
+        memset(pool->sparse + pool->sparse_capacity, 0,
+               sizeof(size_t) * (capacity - pool->sparse_capacity));
+        pool->sparse_capacity = capacity;
+    }
+    pool->sparse[id] = index + 1;
+}
+
+void *component_pool_get(component_pool_t *pool, body_t *body) {
+    size_t id = body_get_id(body);
+    if (id >= pool->sparse_capacity || pool->sparse[id] == 0) {
+        return NULL;
+    }
+    return pool->data + pool->kind->size * (pool->sparse[id] - 1);
+}
+
+void *component_pool_add(component_pool_t *pool, body_t *body) {
+    void *existing = component_pool_get(pool, body);
+    if (existing != NULL) {
+        return existing;
+    }
+    if (pool->size == pool->capacity) {
+        pool_reserve(pool, pool->capacity * POOL_RESIZE_FACTOR);
+    }
+    void *component = pool->data + pool->kind->size * pool->size;
+    memset(component, 0, pool->kind->size);
+    pool->bodies[pool->size] = body;
+    pool_index(pool, body, pool->size);
+    pool->size++;
+    return component;
+}
+
+void component_pool_filter(component_pool_t *pool, keep_func_t keep) {
+    size_t size = pool->kind->size;
+    size_t kept = 0;
+    for (size_t i = 0; i < pool->size; i++) {
+        body_t *body = pool->bodies[i];
+        if (!keep(body) ||
+                (pool->kind->keep != NULL && !pool->kind->keep(pool->data + size * i))) {
+            pool->sparse[body_get_id(body)] = 0;
+            continue;
+        }
+        if (kept != i) {
+            memcpy(pool->data + size * kept, pool->data + size * i, size);
+            pool->bodies[kept] = body;
+            pool->sparse[body_get_id(body)] = kept + 1;
+        }
+        kept++;
+    }
+    pool->size = kept;
+}
+
+void component_pool_set(component_pool_t *pool, body_t **bodies, const void *data,
+                        size_t count) {
+    for (size_t i = 0; i < pool->size; i++) {
+        pool->sparse[body_get_id(pool->bodies[i])] = 0;
+    }
+    pool_reserve(pool, count);
+    if (count > 0) {
+        memcpy(pool->data, data, pool->kind->size * count);
+        memcpy(pool->bodies, bodies, sizeof(body_t *) * count);
+    }
+    for (size_t i = 0; i < count; i++) {
+        pool_index(pool, bodies[i], i);
+    }
+    pool->size = count;
+}
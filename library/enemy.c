@@ -8,6 +8,7 @@
 #include "enemy.h"
 #include "entity.h"
 #include "forces.h"
+#include "motion.h"
 #include "shapelib.h"
 
 const int GAME_ENEMY_MASS = 10;
@@ -18,107 +19,74 @@ const char* GOOSE = "static/goose_spritesheet.png";
 
 //Creates the collisions between player bullets and the enemy.
 void create_bullet_collisions(scene_t *scene, body_t *enemy) {
-    for (int i = 0; i < scene_bodies(scene); i++) {
-        body_t *body = scene_get_body(scene, i);
-        entity_t *entity = body_get_info(body);
-        if (!strcmp(entity_get_type(entity), "BULLET")) {
-            create_destructive_collision(scene, body, enemy);
-        }
+    component_pool_t *bullets = scene_get_bodies_of_type(scene, ENTITY_BULLET);
+    body_t **bodies = component_pool_bodies(bullets);
+    for (size_t i = 0; i < component_pool_size(bullets); i++) {
+        create_destructive_collision(scene, bodies[i], enemy);
     }
 }
 
 //Spawns a goose that flies across the screen, speeding up.
 void spawn_goose(scene_t *scene, vector_t MIN, vector_t MAX) {
-    double *drag_const = malloc(sizeof(double));
-    *drag_const = -(rand()%15+5);
+    //How much faster the goose gets each second, as a fraction of its starting speed.
+    double speedup = (double) (scene_rand(scene)%15+5) / GAME_ENEMY_MASS;
 
     body_t *player = scene_get_body(scene, 3);
-    vector_t center = {MAX.x + ENEMY_RADIUS, rand()%((int)(MAX.y - MIN.y))};
-    entity_t *entity = entity_init("ENEMY", true, false);
+    vector_t center = {MAX.x + ENEMY_RADIUS,
+                       scene_rand(scene)%((int)(MAX.y - MIN.y))};
     list_t *goose_coords = compute_rect_points(center, 2*ENEMY_RADIUS, 2*ENEMY_RADIUS);
-    body_t *goose = body_init_with_info(goose_coords, GAME_ENEMY_MASS, entity,
-                                        entity_free);
-    sprite_t *goose_info = sprite_animated(GOOSE, 1, 10, 12);
+    body_t *goose = body_init(goose_coords, GAME_ENEMY_MASS);
+    sprite_t *goose_info = sprite_animated(scene_get_context(scene),
+                                           GOOSE, 1, 10, 12);
     body_set_draw(goose, (draw_func_t) sdl_draw_animated, goose_info, sprite_free);
-    create_drag(scene, drag_const, goose, free);
-    scene_add_body(scene, goose);
+    entity_add(scene, goose, ENTITY_ENEMY);
+    //Flies back against the camera, so it crosses the screen faster than the level.
+    vector_t velocity = vec_negate(scene_get_camera_velocity(scene));
+    motion_add_acceleration(scene, goose, velocity, vec_multiply(speedup, velocity));
     create_destructive_collision(scene, player, goose);
     create_bullet_collisions(scene, goose);
-    create_bounds_collisions(scene, goose, ENEMY_RADIUS);
+    create_bounds_culling(scene, goose, ENEMY_RADIUS);
 }
 
 //Spawns a frog that bounces up and down the screen.
 void spawn_frog(scene_t *scene, vector_t MIN, vector_t MAX) {
-    double *spring_const = malloc(sizeof(double));
-    *spring_const = rand()%15+5;
+    double spring_const = scene_rand(scene)%15+5;
 
     body_t *player = scene_get_body(scene, 3);
 
-    vector_t center = {MAX.x + ENEMY_RADIUS, rand()%((int)(MAX.y - MIN.y))};
-    entity_t *entity = entity_init("ENEMY", false, false);
+    vector_t center = {MAX.x + ENEMY_RADIUS,
+                       scene_rand(scene)%((int)(MAX.y - MIN.y))};
     list_t *frog_coords = compute_rect_points(center, 2*ENEMY_RADIUS, 2*ENEMY_RADIUS);
-    body_t *frog = body_init_with_info(frog_coords, GAME_ENEMY_MASS, entity, entity_free);
-    sprite_t *frog_info = sprite_animated(FROG, 1, 8, 6);
+    body_t *frog = body_init(frog_coords, GAME_ENEMY_MASS);
+    sprite_t *frog_info = sprite_animated(scene_get_context(scene),
+                                          FROG, 1, 8, 6);
     body_set_draw(frog, (draw_func_t) sdl_draw_animated, frog_info, sprite_free);
-    center.y = MAX.y / 2;
-    entity = entity_init("ANCHOR", true, false);
-    list_t *anchor_coords = compute_circle_points(center, ENEMY_RADIUS, ENEMY_RADIUS);
-    body_t *anchor = body_init_with_info(anchor_coords, INFINITY, entity, entity_free);
-
-    create_spring(scene, spring_const, anchor, frog, free);
-
-    scene_add_body(scene, frog);
-    scene_add_body(scene, anchor);
+    entity_add(scene, frog, ENTITY_ENEMY);
+    //Bounces as if on a spring anchored halfway up the screen.
+    vector_t amplitude = {0, center.y - (MIN.y + MAX.y) / 2};
+    motion_add_oscillation(scene, frog, amplitude, sqrt(spring_const / GAME_ENEMY_MASS));
     create_destructive_collision(scene, player, frog);
     create_bullet_collisions(scene, frog);
-    create_bounds_collisions(scene, frog, ENEMY_RADIUS);
-    create_bounds_collisions(scene, anchor, ENEMY_RADIUS);
-}
-
-//Temporary param struct for the fly's gravity creator.
-typedef struct param {
-    double constant;
-    body_t *body1;
-    body_t *body2;
-} param_t;
-
-//One-way gravity creator that attracts the fly to the player.
-void one_way_gravity_creator(param_t *aux){
-    vector_t r = vec_subtract(body_get_centroid(aux->body1),
-                              body_get_centroid(aux->body2));
-    double mass_product = body_get_mass(aux->body1)* body_get_mass(aux->body2);
-    vector_t force = VEC_ZERO;
-    force = vec_multiply(-aux->constant * mass_product / pow(sqrt(vec_dot(r,r)), 3.0), r);
-    body_add_force(aux->body1, force);
-}
-
-//Attracts the fly to a player by applying gravity only to body1 (the fly).
-void create_one_way_gravity(scene_t *scene, double G, body_t *body1, body_t *body2){
-    param_t *force_param = malloc(sizeof(param_t));
-    *force_param = (param_t){G, body1, body2};
-    list_t *bodies = list_init(2, body_free);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    scene_add_bodies_force_creator(scene, one_way_gravity_creator, force_param, bodies,
-                                   free);
+    create_bounds_culling(scene, frog, ENEMY_RADIUS);
 }
 
-//Spawns a fly that lazily follows the player and is attracted to the player.
+//Spawns a fly that lazily follows the player.
 void spawn_fly(scene_t *scene, vector_t MIN, vector_t MAX) {
-    double gravity_const = rand()%500000+500000;
+    double speed = scene_rand(scene)%100+50;
 
     body_t *player = scene_get_body(scene, 3);
-    vector_t center = {MAX.x + ENEMY_RADIUS, rand()%((int)(MAX.y - MIN.y))};
-    entity_t *entity = entity_init("ENEMY", true, false);
+    vector_t center = {MAX.x + ENEMY_RADIUS,
+                       scene_rand(scene)%((int)(MAX.y - MIN.y))};
     list_t *fly_coords = compute_rect_points(center, ENEMY_RADIUS, ENEMY_RADIUS);
-    body_t *fly = body_init_with_info(fly_coords, GAME_ENEMY_MASS,  entity, entity_free);
-    sprite_t *fly_info = sprite_animated(FLY, 1, 2, 20);
+    body_t *fly = body_init(fly_coords, GAME_ENEMY_MASS);
+    sprite_t *fly_info = sprite_animated(scene_get_context(scene),
+                                         FLY, 1, 2, 20);
     body_set_draw(fly, (draw_func_t) sdl_draw_animated, fly_info, sprite_free);
-    create_one_way_gravity(scene, gravity_const, fly, player);
-    scene_add_body(scene, fly);
+    entity_add(scene, fly, ENTITY_ENEMY);
+    motion_add_seek(scene, fly, player, speed);
     create_destructive_collision(scene, player, fly);
     create_bullet_collisions(scene, fly);
-    create_bounds_collisions(scene, fly, ENEMY_RADIUS/2);
+    create_bounds_culling(scene, fly, ENEMY_RADIUS/2);
 }
 
 void enemy_spawn_random(scene_t *scene, vector_t MIN, vector_t MAX) {
@@ -126,7 +94,7 @@ void enemy_spawn_random(scene_t *scene, vector_t MIN, vector_t MAX) {
     int percent_goose = 10;
     int percent_frog = 60;
     int percent_fly = 100;
-    int random_enemy = rand()%percent_max;
+    int random_enemy = scene_rand(scene)%percent_max;
     if (random_enemy <= percent_goose) {
         spawn_goose(scene, MIN, MAX);
     }
@@ -1,82 +1,111 @@
+#include <assert.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include "entity.h"
 
-typedef struct entity {
-    char *entity_type;
-    bool scrollable;
-    bool fallable;
-    bool is_scrolling;
-} entity_t;
-
-typedef struct player_entity {
-    char *entity_type;
-    bool scrollable;
-    bool fallable;
-    bool is_scrolling;
-    bool is_colliding;
-    char *active_powerup;
-    int num_coins;
-} player_entity_t;
-
-entity_t *entity_init(char *entity_type, bool scrollable, bool fallable) {
-    entity_t *entity = malloc(sizeof(entity_t));
-    entity->entity_type = entity_type;
-    entity->scrollable = scrollable;
-    entity->fallable = fallable;
-    entity->is_scrolling = false;
-    return entity;
-}
+//Names of the entity types, indexed by type; starts with the built-in types.
+//Shared by every scene in the process, so it is guarded by types_lock.
+const char **type_names = NULL;
+size_t num_types = 0;
+size_t types_capacity = 0;
+
+#ifdef _WIN32
+
+//No pthreads on Windows, where scenes only ever tick on one thread (see jobs.c).
+void lock_types(void) {}
+void unlock_types(void) {}
+
+#else
+
+#include <pthread.h>
 
-player_entity_t *player_entity_init(char *entity_type, bool scrollable, bool fallable) {
-    player_entity_t *player_entity = malloc(sizeof(player_entity_t));
-    player_entity->entity_type = entity_type;
-    player_entity->scrollable = scrollable;
-    player_entity->fallable = fallable;
-    player_entity->is_scrolling = false;
-    player_entity->is_colliding = false;
-    player_entity->active_powerup = "NONE";
-    player_entity->num_coins = 0;
-    return player_entity;
+pthread_mutex_t types_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void lock_types(void) {
+    pthread_mutex_lock(&types_lock);
 }
 
-void entity_free(entity_t *entity) {
-    free(entity);
+void unlock_types(void) {
+    pthread_mutex_unlock(&types_lock);
 }
 
-char *entity_get_type(entity_t *entity) {
-    return entity->entity_type;
+#endif
+
+const char *BUILTIN_TYPES[] = {"NONE", "BACKGROUND", "PLAYER", "TERRAIN", "PLATFORM",
+                               "BULLET", "ENEMY", "POWERUP", "COIN"};
+
+const char *POWERUP_NAMES[] = {"NONE", "SLOW", "JUMP", "MAGNET"};
+
+const component_kind_t PLAYER_STATE = {
+    .name = "player state",
+    .size = sizeof(player_state_t)
+};
+
+//Appends a name to the type table.
+entity_type_t add_type_name(const char *name) {
+    if (num_types == types_capacity) {
+        types_capacity = types_capacity == 0 ? 16 : types_capacity * 2;
+        type_names = realloc(type_names, sizeof(char *) * types_capacity);
+        assert(type_names != NULL);
+    }
+    type_names[num_types] = name;
+    return num_types++;
 }
 
-bool entity_get_scrollable(entity_t *entity) {
-    return entity->scrollable;
+entity_type_t entity_type_intern(const char *name) {
+    lock_types();
+    if (num_types == 0) {
+        for (size_t i = 0; i < sizeof(BUILTIN_TYPES) / sizeof(char *); i++) {
+            add_type_name(BUILTIN_TYPES[i]);
+        }
+    }
+    for (size_t i = 0; i < num_types; i++) {
+        if (!strcmp(type_names[i], name)) {
+            unlock_types();
+            return i;
+        }
+    }
+    entity_type_t type = add_type_name(name);
+    unlock_types();
+    return type;
 }
 
-bool entity_get_fallable(entity_t *entity) {
-    return entity->fallable;
+const char *entity_type_name(entity_type_t type) {
+    if (type < sizeof(BUILTIN_TYPES) / sizeof(char *)) {
+        return BUILTIN_TYPES[type];
+    }
+    lock_types();
+    assert(type < num_types);
+    const char *name = type_names[type];
+    unlock_types();
+    return name;
 }
 
-bool entity_is_scrolling(entity_t *entity) {
-    return entity->is_scrolling;
+void entity_add(scene_t *scene, body_t *body, entity_type_t type) {
+    scene_add_body(scene, body);
+    scene_set_type(scene, body, type);
 }
 
-void entity_set_scrolling(entity_t *entity) {
-    entity->is_scrolling = true;
+player_state_t *entity_add_player_state(scene_t *scene, body_t *body) {
+    player_state_t *state = scene_add_component(scene, body, &PLAYER_STATE);
+    state->active_powerup = POWERUP_NONE;
+    state->num_coins = 0;
+    return state;
 }
 
-bool entity_get_colliding(player_entity_t *entity) {
-    return entity->is_colliding;
+player_state_t *entity_get_player_state(scene_t *scene, body_t *body) {
+    return scene_get_component(scene, body, &PLAYER_STATE);
 }
 
-void entity_set_colliding(player_entity_t *entity, bool value) {
-    entity->is_colliding = value;
+powerup_t entity_get_powerup(player_state_t *state) {
+    return state->active_powerup;
 }
 
-char *entity_get_powerup(player_entity_t *entity) {
-    return entity->active_powerup;
+void entity_set_powerup(player_state_t *state, powerup_t new_powerup) {
+    state->active_powerup = new_powerup;
 }
 
-void entity_set_powerup(player_entity_t *entity, char *new_powerup) {
-    entity->active_powerup = new_powerup;
+const char *entity_powerup_name(powerup_t powerup) {
+    return POWERUP_NAMES[powerup];
 }
@@ -7,31 +7,30 @@
 
 #include "forces.h"
 #include "collision.h"
-#include "entity.h"
+#include "quadtree.h"
 
 //Gravity is not applied when two bodies are closer than this distance to each other.
 const double SMALL_DISTANCE = 10;
-//Normal force is not applied when two bodies are closer than this distance to each other.
-const double SMALL_VALUE = 1e-6;
 
 /**
- * Contains the information for a force creator,
- * and is used as input for the force handler.
+ * Parameters of a force that acts on a single body.
+ * The constant is an acceleration for constant forces
+ * and a drag coefficient (in its x component) for drag.
  */
-typedef struct param {
-    void *constant;
-    body_t *body1;
-    body_t *body2;
-    free_func_t const_freer;
-} param_t;
+typedef struct {
+    body_t *body;
+    vector_t constant;
+} body_param_t;
 
 /**
- * Frees a param_t, which is used as input for force handlers.
+ * Parameters of a force that acts between two bodies,
+ * e.g. a spring constant or a gravitational constant.
  */
-void param_free(param_t *param) {
-    param->const_freer(param->constant);
-    free(param);
-}
+typedef struct {
+    body_t *body1;
+    body_t *body2;
+    double constant;
+} pair_param_t;
 
 double calculate_reduced_mass(body_t *body1, body_t *body2) {
     double reduced_mass;
@@ -45,153 +44,460 @@ double calculate_reduced_mass(body_t *body1, body_t *body2) {
     }
     return reduced_mass;
 }
- 
+
+//The velocity of two bodies' center of mass, or of the heavier body if
+//either has infinite mass.
+vector_t center_of_mass_velocity(body_t *body1, body_t *body2) {
+    double mass1 = body_get_mass(body1);
+    double mass2 = body_get_mass(body2);
+    if (mass1 == INFINITY) {
+        return body_get_velocity(body1);
+    }
+    if (mass2 == INFINITY) {
+        return body_get_velocity(body2);
+    }
+    return vec_multiply(1 / (mass1 + mass2),
+                        vec_add(vec_multiply(mass1, body_get_velocity(body1)),
+                                vec_multiply(mass2, body_get_velocity(body2))));
+}
+
 /**
- * Gravity force handler for newtonian gravity between 2 bodies.
- * 
- * @param aux a param_t containing the information for the force.
+ * Computes the newtonian gravity that body2 exerts on body1.
+ * Returns zero when the bodies are too close together.
+ */
+vector_t compute_gravity(body_t *body1, body_t *body2, double G) {
+    vector_t r = vec_subtract(body_get_centroid(body1), body_get_centroid(body2));
+    double distance = sqrt(vec_dot(r, r));
+    if (distance <= SMALL_DISTANCE) {
+        return VEC_ZERO;
+    }
+    double mass_product = body_get_mass(body1) * body_get_mass(body2);
+    return vec_multiply(-G * mass_product / (distance * distance * distance), r);
+}
+
+/**
+ * Force creator for a batch of newtonian gravity forces between 2 bodies.
+ *
+ * @param params the parameters of each force in the batch
+ * @param count the number of forces in the batch
+ * @param buffer where to collect the forces, or NULL to apply them directly
  */
-void gravity_creator(param_t *aux){
-    vector_t r = vec_subtract(body_get_centroid(aux->body1),
-                              body_get_centroid(aux->body2));
-    double mass_product = body_get_mass(aux->body1)* body_get_mass(aux->body2);
-    vector_t force = VEC_ZERO;
-    if (sqrt(vec_dot(r, r)) > SMALL_DISTANCE){
-        force = vec_multiply(- *(double *)aux->constant * mass_product /
-                             pow(sqrt(vec_dot(r,r)), 3.0) , r);
+void gravity_creator(scene_t *scene, pair_param_t *params, size_t count,
+                     force_buffer_t *buffer){
+    for (size_t i = 0; i < count; i++) {
+        vector_t force = compute_gravity(params[i].body1, params[i].body2,
+                                         params[i].constant);
+        force_buffer_add(buffer, params[i].body1, force);
+        force_buffer_add(buffer, params[i].body2, vec_negate(force));
     }
-    body_add_force(aux->body1, force);
-    body_add_force(aux->body2, vec_negate(force));
 }
 
-void create_newtonian_gravity(scene_t *scene, void *G, body_t *body1, body_t *body2,
-                              free_func_t freer){
-    param_t *force_param = malloc(sizeof(param_t));
-    *force_param = (param_t){G, body1, body2, freer};
-    list_t *bodies = list_init(2, body_free);
+const force_kind_t NEWTONIAN_GRAVITY = {
+    .name = "gravity",
+    .param_size = sizeof(pair_param_t),
+    .creator = (force_batch_creator_t) gravity_creator,
+    .parallel = true
+};
+
+/**
+ * Force creator for a batch of one-way gravity forces,
+ * which only pull body1 towards body2.
+ *
+ * @param params the parameters of each force in the batch
+ * @param count the number of forces in the batch
+ * @param buffer where to collect the forces, or NULL to apply them directly
+ */
+void one_way_gravity_creator(scene_t *scene, pair_param_t *params, size_t count,
+                             force_buffer_t *buffer){
+    for (size_t i = 0; i < count; i++) {
+        force_buffer_add(buffer, params[i].body1, compute_gravity(params[i].body1,
+                                                        params[i].body2,
+                                                        params[i].constant));
+    }
+}
+
+const force_kind_t ONE_WAY_GRAVITY = {
+    .name = "one-way gravity",
+    .param_size = sizeof(pair_param_t),
+    .creator = (force_batch_creator_t) one_way_gravity_creator,
+    .parallel = true
+};
+
+/**
+ * Registers a force between two bodies with the scene.
+ */
+void add_pair_force(scene_t *scene, const force_kind_t *kind, double constant,
+                    body_t *body1, body_t *body2) {
+    pair_param_t params = {body1, body2, constant};
+    list_t *bodies = list_init(2, NULL);
     list_add(bodies, body1);
     list_add(bodies, body2);
-    scene_add_bodies_force_creator(scene, gravity_creator, force_param, bodies,
-                                   param_free);
+    scene_add_batched_force(scene, kind, &params, bodies);
 }
 
 /**
- * Force handler for a constant magnitude force that acts on a body
+ * Registers a force on a single body with the scene.
+ */
+void add_body_force(scene_t *scene, const force_kind_t *kind, vector_t constant,
+                    body_t *body) {
+    body_param_t params = {body, constant};
+    list_t *bodies = list_init(1, NULL);
+    list_add(bodies, body);
+    scene_add_batched_force(scene, kind, &params, bodies);
+}
+
+void create_newtonian_gravity(scene_t *scene, double G, body_t *body1, body_t *body2){
+    add_pair_force(scene, &NEWTONIAN_GRAVITY, G, body1, body2);
+}
+
+void create_one_way_gravity(scene_t *scene, double G, body_t *body1, body_t *body2){
+    add_pair_force(scene, &ONE_WAY_GRAVITY, G, body1, body2);
+}
+
+/**
+ * Parameters of a gravity field between every body of one type.
+ */
+typedef struct {
+    size_t type;
+    double G;
+    double theta;
+} gravity_field_param_t;
+
+/**
+ * Force creator for a batch of gravity fields. Each field builds a quadtree
+ * over its bodies and walks it once per body, so a field of n bodies costs
+ * O(n log n) instead of the O(n^2) of a gravity force per pair.
+ *
+ * @param params the parameters of each field in the batch
+ * @param count the number of fields in the batch
+ * @param buffer where to collect the forces, or NULL to apply them directly
+ */
+void gravity_field_creator(scene_t *scene, gravity_field_param_t *params, size_t count,
+                           force_buffer_t *buffer){
+    for (size_t i = 0; i < count; i++) {
+        component_pool_t *pool = scene_get_bodies_of_type(scene, params[i].type);
+        body_t **bodies = component_pool_bodies(pool);
+        size_t size = component_pool_size(pool);
+        quadtree_t *tree = quadtree_init(bodies, size);
+        for (size_t j = 0; j < size; j++) {
+            force_buffer_add(buffer, bodies[j],
+                             quadtree_gravity(tree, bodies[j], params[i].G,
+                                              params[i].theta, SMALL_DISTANCE));
+        }
+        quadtree_free(tree);
+    }
+}
+
+const force_kind_t GRAVITY_FIELD = {
+    .name = "gravity field",
+    .param_size = sizeof(gravity_field_param_t),
+    .creator = (force_batch_creator_t) gravity_field_creator,
+    .parallel = true
+};
+
+void create_gravity_field(scene_t *scene, double G, double theta, size_t type){
+    //Make the type's index now, so the creator only reads the scene.
+    scene_get_bodies_of_type(scene, type);
+    gravity_field_param_t params = {type, G, theta};
+    scene_add_batched_force(scene, &GRAVITY_FIELD, &params, NULL);
+}
+
+/**
+ * Force creator for a batch of constant accelerations that act on a body
  * all the time.
  * 
- * @param aux auxilary param containing the information for the force.
+ * @param params the parameters of each force in the batch
+ * @param count the number of forces in the batch
+ * @param buffer where to collect the forces, or NULL to apply them directly
  */
-void const_force_creator(param_t *aux){
-    vector_t force = vec_multiply(body_get_mass(aux->body1), *(vector_t *) aux->constant);
-    body_add_force(aux->body1, force);
+void const_force_creator(scene_t *scene, body_param_t *params, size_t count,
+                         force_buffer_t *buffer){
+    for (size_t i = 0; i < count; i++) {
+        force_buffer_add(buffer, params[i].body,
+                       vec_multiply(body_get_mass(params[i].body), params[i].constant));
+    }
 }
 
-void create_constant_force(scene_t *scene, void *A, body_t *body, free_func_t freer){
-    param_t *force_param = malloc(sizeof(param_t));
-    *force_param = (param_t){A, body, NULL, freer};
-    list_t *bodies = list_init(1, body_free);
-    list_add(bodies, body);
-    scene_add_bodies_force_creator(scene, const_force_creator, force_param, bodies,
-                                   param_free);
+const force_kind_t CONSTANT_FORCE = {
+    .name = "constant",
+    .param_size = sizeof(body_param_t),
+    .creator = (force_batch_creator_t) const_force_creator,
+    .parallel = true
+};
+
+void create_constant_force(scene_t *scene, vector_t A, body_t *body){
+    add_body_force(scene, &CONSTANT_FORCE, A, body);
 }
 
 /**
- * Force handler for a spring force between 2 bodies.
+ * Parameters of a constant acceleration over a region.
+ */
+typedef struct {
+    vector_t acceleration;
+    aabb_t region;
+    uint64_t types;
+} force_field_param_t;
+
+//Accelerates the bodies in an array that are in a field's region.
+void apply_force_field(force_field_param_t *field, body_t **bodies, size_t count,
+                       force_buffer_t *buffer) {
+    for (size_t i = 0; i < count; i++) {
+        double mass = body_get_mass(bodies[i]);
+        if (mass != INFINITY && aabb_contains(field->region,
+                                              body_get_centroid(bodies[i]))) {
+            force_buffer_add(buffer, bodies[i], vec_multiply(mass, field->acceleration));
+        }
+    }
+}
+
+/**
+ * Force creator for a batch of force fields. A field over every body walks
+ * the scene's bodies; otherwise it walks the index of each of its types.
+ *
+ * @param params the parameters of each field in the batch
+ * @param count the number of fields in the batch
+ * @param buffer where to collect the forces, or NULL to apply them directly
+ */
+void force_field_creator(scene_t *scene, force_field_param_t *params, size_t count,
+                         force_buffer_t *buffer){
+    for (size_t i = 0; i < count; i++) {
+        if (params[i].types == ALL_TYPES) {
+            for (size_t j = 0; j < scene_bodies(scene); j++) {
+                body_t *body = scene_get_body(scene, j);
+                apply_force_field(&params[i], &body, 1, buffer);
+            }
+            continue;
+        }
+        for (size_t type = 1; type < 64; type++) {
+            if (params[i].types & ((uint64_t) 1 << type)) {
+                component_pool_t *pool = scene_get_bodies_of_type(scene, type);
+                apply_force_field(&params[i], component_pool_bodies(pool),
+                                  component_pool_size(pool), buffer);
+            }
+        }
+    }
+}
+
+//Moves the regions of a batch of force fields with the scene's origin.
+void force_field_rebase(force_field_param_t *params, size_t count, vector_t origin){
+    vector_t shift = vec_negate(origin);
+    for (size_t i = 0; i < count; i++) {
+        params[i].region.min = vec_add(params[i].region.min, shift);
+        params[i].region.max = vec_add(params[i].region.max, shift);
+    }
+}
+
+const force_kind_t FORCE_FIELD = {
+    .name = "force field",
+    .param_size = sizeof(force_field_param_t),
+    .creator = (force_batch_creator_t) force_field_creator,
+    .parallel = true,
+    .rebase = (force_batch_rebase_t) force_field_rebase
+};
+
+void create_force_field(scene_t *scene, vector_t A, aabb_t region, uint64_t types){
+    if (types != ALL_TYPES) {
+        //Make the types' indices now, so the creator only reads the scene.
+        for (size_t type = 1; type < 64; type++) {
+            if (types & ((uint64_t) 1 << type)) {
+                scene_get_bodies_of_type(scene, type);
+            }
+        }
+    }
+    force_field_param_t params = {A, region, types};
+    scene_add_batched_force(scene, &FORCE_FIELD, &params, NULL);
+}
+
+/**
+ * Force creator for a batch of spring forces between 2 bodies.
+ * The springs are integrated implicitly, so each body is given the stiffness
+ * that, with the other body's, stops the pair at the rest point in one tick
+ * when the spring is very stiff, rather than overshooting it. The stiffness
+ * only acts on the bodies' motion relative to each other, so a pair moving
+ * together (or a body on a moving anchor) keeps its shared velocity.
  * 
- * @param aux auxilary parameter containing the information for the force.
+ * @param params the parameters of each force in the batch
+ * @param count the number of forces in the batch
+ * @param buffer where to collect the forces, or NULL to apply them directly
  */
-void spring_creator(param_t *aux){
-    vector_t r = vec_subtract(body_get_centroid(aux->body1),
-                              body_get_centroid(aux->body2));
-    vector_t force = vec_multiply(-1 * *(double *) aux->constant, r);
-    body_add_force(aux->body1, force);
-    body_add_force(aux->body2, vec_negate(force));
-} 
-
-void create_spring(scene_t *scene, void *k, body_t *body1, body_t *body2,
-                   free_func_t freer){
-    param_t *force_param = malloc(sizeof(param_t));
-    *force_param = (param_t){k, body1, body2, freer};
-    list_t *bodies = list_init(2, body_free);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    scene_add_bodies_force_creator(scene, spring_creator, force_param, bodies,
-                                   param_free);
+void spring_creator(scene_t *scene, pair_param_t *params, size_t count,
+                    force_buffer_t *buffer){
+    for (size_t i = 0; i < count; i++) {
+        vector_t r = vec_subtract(body_get_centroid(params[i].body1),
+                                  body_get_centroid(params[i].body2));
+        double k = params[i].constant;
+        vector_t force = vec_multiply(-k, r);
+        //Each body closes the share of the gap that conserves momentum,
+        //measured from the pair's center of mass so their shared motion is kept.
+        double reduced_mass = calculate_reduced_mass(params[i].body1, params[i].body2);
+        vector_t center = center_of_mass_velocity(params[i].body1, params[i].body2);
+        force_buffer_add_implicit(buffer, params[i].body1, force, 0,
+                                  k * body_get_mass(params[i].body1) / reduced_mass, center);
+        force_buffer_add_implicit(buffer, params[i].body2, vec_negate(force), 0,
+                                  k * body_get_mass(params[i].body2) / reduced_mass, center);
+    }
+}
+
+const force_kind_t SPRING = {
+    .name = "spring",
+    .param_size = sizeof(pair_param_t),
+    .creator = (force_batch_creator_t) spring_creator,
+    .parallel = true
+};
+
+void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2){
+    add_pair_force(scene, &SPRING, k, body1, body2);
 }
 
 /**
- * Force handler for a drag force that is proportional to velocity
- * and acts opposite direction of travel.
+ * Force creator for a batch of drag forces that are proportional to velocity
+ * and act opposite the direction of travel.
+ * The drag is integrated exactly (see body_add_implicit_force()).
  * 
- * @param aux auxilary parameter containing the information for the force.
+ * @param params the parameters of each force in the batch
+ * @param count the number of forces in the batch
+ * @param buffer where to collect the forces, or NULL to apply them directly
  */
-void drag_creator(param_t *aux){
-    vector_t force = vec_multiply(- *(double *) aux->constant,
-                                  body_get_velocity(aux->body1));
-    body_add_force(aux->body1, force);
+void drag_creator(scene_t *scene, body_param_t *params, size_t count,
+                  force_buffer_t *buffer){
+    for (size_t i = 0; i < count; i++) {
+        force_buffer_add_implicit(buffer, params[i].body, VEC_ZERO,
+                                  params[i].constant.x, 0, VEC_ZERO);
+    }
 }
 
-void create_drag(scene_t *scene, void *gamma, body_t *body, free_func_t freer){
-    param_t *force_param = malloc(sizeof(param_t));
-    *force_param = (param_t){ gamma, body, NULL, freer};
-    list_t *bodies = list_init(1, body_free);
-    list_add(bodies, body);
-    scene_add_bodies_force_creator(scene, drag_creator, force_param, bodies, param_free);
+const force_kind_t DRAG = {
+    .name = "drag",
+    .param_size = sizeof(body_param_t),
+    .creator = (force_batch_creator_t) drag_creator,
+    .parallel = true
+};
+
+void create_drag(scene_t *scene, double gamma, body_t *body){
+    add_body_force(scene, &DRAG, (vector_t) {gamma, 0}, body);
 }
 
 /**
  * Struct containing the information of a collision, is passed to the force
  * creator and the collision handler is called on the bodies.
+ * Exactly one of handler and contact_handler is set.
  */
 typedef struct {
     collision_handler_t handler;
+    contact_handler_t contact_handler;
     body_t *body1;
     body_t *body2;
     void *aux;
-    bool collided;
     free_func_t aux_freer;
+    //Result of this tick's broadphase and collision tests, filled in by collision_prepare.
+    bool near;
+    collision_info_t collision;
 } collision_param_t;
 
 /**
- * Frees a collision parameter.
+ * Frees the auxiliary value of a collision parameter.
  */
 void collision_param_free(collision_param_t *param) {
-    if (param->aux != NULL) {
+    if (param->aux != NULL && param->aux_freer != NULL) {
         param->aux_freer(param->aux);
     }
-    free(param);
 }
 
 /**
- * Force creator that calls the collision handler if 2 objects are collided.
+ * Tests each pair of bodies in the batch for a collision. Only pairs whose
+ * bounding boxes overlap are handed to the narrowphase, which tests pairs of
+ * rectangles by their bounding boxes and first tries the axis that separated
+ * any other pair last time (see contact_t). The pairs are
+ * independent and the pair cache is only read, so this step may run
+ * on several threads at once.
+ *
+ * @param params the collision parameters of each pair in the batch
+ * @param count the number of pairs in the batch
+ */
+void collision_prepare(scene_t *scene, collision_param_t *params, size_t count,
+                       force_buffer_t *buffer) {
+    pair_cache_t *cache = scene_get_pair_cache(scene);
+    for (size_t i = 0; i < count; i++) {
+        collision_param_t *param = &params[i];
+        param->near = aabb_overlaps(body_get_aabb(param->body1),
+                                    body_get_aabb(param->body2));
+        if (!param->near) {
+            param->collision = (collision_info_t) {false, VEC_ZERO, 0, 0};
+            continue;
+        }
+        const contact_t *contact = pair_cache_get(cache, param->body1, param->body2);
+        vector_t hint = contact != NULL ? contact->separating_axis : VEC_ZERO;
+        param->collision = find_body_collision(param->body1, param->body2, hint);
+    }
+}
+
+/**
+ * Force creator that records each pair of bodies in the batch in the scene's
+ * pair cache and calls the handlers of the pairs whose contact changed.
+ * Handlers run one at a time, in the order the collisions were added.
  * 
- * @param param a collision parameter that contains the information of the
- *      collision.
+ * @param params the collision parameters of each pair in the batch
+ * @param count the number of pairs in the batch
+ * @param buffer unused, handlers always act on the bodies directly
  */
-void collision_force_creator(collision_param_t *param) {
-    list_t *shape1 = body_get_shape(param->body1);
-    list_t *shape2 = body_get_shape(param->body2);
-    collision_info_t collision = find_collision(shape1, shape2);
-    if (collision.collided && !(param->collided)) {
-        param->handler(param->body1, param->body2, collision.axis, param->aux);
-        param->collided = true;
-    } else if (!collision.collided) {
-        param->collided = false;
+void collision_force_creator(scene_t *scene, collision_param_t *params, size_t count,
+                             force_buffer_t *buffer) {
+    pair_cache_t *cache = scene_get_pair_cache(scene);
+    size_t tests = 0;
+    size_t axes = 0;
+    size_t hits = 0;
+    size_t fired = 0;
+    for (size_t i = 0; i < count; i++) {
+        collision_param_t *param = &params[i];
+        if (param->near) {
+            tests++;
+            axes += param->collision.axes_tested;
+            hits += param->collision.hint_separated;
+        }
+        contact_event_t event = pair_cache_update(cache, param->body1, param->body2,
+                                                  param->near, param->collision);
+        if (param->contact_handler != NULL && event != CONTACT_NONE) {
+            vector_t axis = event == CONTACT_EXIT ? VEC_ZERO : param->collision.axis;
+            param->contact_handler(param->body1, param->body2, event, axis, param->aux);
+            fired++;
+        } else if (param->handler != NULL && event == CONTACT_ENTER) {
+            param->handler(param->body1, param->body2, param->collision.axis, param->aux);
+            fired++;
+        }
     }
-    free(shape1);
-    free(shape2);
+    scene_count_narrowphase(scene, tests, axes, hits, fired);
 }
 
-void create_collision(scene_t *scene, body_t *body1, body_t *body2,
-            collision_handler_t handler, void *aux, free_func_t freer) {
-    list_t *bodies = list_init(2, body_free);
+const force_kind_t COLLISION = {
+    .name = "collision",
+    .param_size = sizeof(collision_param_t),
+    .creator = (force_batch_creator_t) collision_force_creator,
+    .prepare = (force_batch_creator_t) collision_prepare,
+    .param_freer = (free_func_t) collision_param_free
+};
+
+/**
+ * Registers a collision force between two bodies with the scene.
+ */
+void add_collision(scene_t *scene, body_t *body1, body_t *body2,
+                   collision_handler_t handler, contact_handler_t contact_handler,
+                   void *aux, free_func_t freer) {
+    list_t *bodies = list_init(2, NULL);
     list_add(bodies, body1);
     list_add(bodies, body2);
-    collision_param_t *force_param = malloc(sizeof(collision_param_t));
-    *force_param = (collision_param_t) {handler, body1, body2, aux, false,
-                                        freer};
-    scene_add_bodies_force_creator(scene, collision_force_creator, force_param,
-                                        bodies, collision_param_free);
+    collision_param_t params = {handler, contact_handler, body1, body2, aux, freer,
+                                false, {false}};
+    scene_add_batched_force(scene, &COLLISION, &params, bodies);
+}
+
+void create_collision(scene_t *scene, body_t *body1, body_t *body2,
+            collision_handler_t handler, void *aux, free_func_t freer) {
+    add_collision(scene, body1, body2, handler, NULL, aux, freer);
+}
+
+void create_contact_collision(scene_t *scene, body_t *body1, body_t *body2,
+            contact_handler_t handler, void *aux, free_func_t freer) {
+    add_collision(scene, body1, body2, NULL, handler, aux, freer);
 }
 
 /**
@@ -221,102 +527,6 @@ void physics_collision_handler(body_t *body1, body_t *body2,
     }
 }
 
-/**
- * Struct containing the information for normal collisions.
- */
-typedef struct normal_param {
-    normal_handler_t handler;
-    body_t *body1;
-    body_t *body2;
-    void *aux;
-    bool collided;
-    free_func_t aux_freer;
-} normal_param_t;
-
-/**
- * Frees the information for a normal collision.
- */
-void normal_param_free(normal_param_t *param) {
-    param->aux_freer(param->aux);
-    free(param);
-}
-
-/**
- * Force handler for normal forces.
- * 
- * @param param parameter containing the information for the normal collision.
- */
-void normal_handler(normal_param_t *param){
-    list_t *shape1 = body_get_shape(param->body1);
-    list_t *shape2 = body_get_shape(param->body2);
-
-    vector_t shape1_min = *(vector_t *) list_get(shape1,0);
-    vector_t shape1_max = *(vector_t *) list_get(shape1,0);
-
-    vector_t shape2_min = *(vector_t *) list_get(shape2,0);
-    vector_t shape2_max = *(vector_t *) list_get(shape2,0);
-
-    for (int i = 0; i < list_size(shape1); i++) {
-        shape1_min.x = fmin(shape1_min.x, (*(vector_t *) list_get(shape1,i)).x);
-        shape1_max.x = fmax(shape1_max.x, (*(vector_t *) list_get(shape1,i)).x);
-        shape1_min.y = fmin(shape1_min.y, (*(vector_t *) list_get(shape1,i)).y);
-        shape1_max.y = fmax(shape1_max.y, (*(vector_t *) list_get(shape1,i)).y);
-    }
-    for (int i = 0; i < list_size(shape2); i++) {
-        shape2_min.x = fmin(shape2_min.x, (*(vector_t *) list_get(shape2,i)).x);
-        shape2_max.x = fmax(shape2_max.x, (*(vector_t *) list_get(shape2,i)).x);
-        shape2_min.y = fmin(shape2_min.y, (*(vector_t *) list_get(shape2,i)).y);
-        shape2_max.y = fmax(shape2_max.y, (*(vector_t *) list_get(shape2,i)).y);
-    }
-
-    if (body_get_velocity(param->body1).y < 0 &&
-            shape1_max.x > shape2_min.x && shape1_min.x < shape2_max.x &&
-            shape1_min.y > shape2_max.y &&
-            shape1_min.y - shape2_max.y < SMALL_DISTANCE) {
-        player_entity_t *entity1 = body_get_info(param->body1); //This must be the player.
-        entity_set_colliding(entity1, true);
-        vector_t new_centroid = {body_get_centroid(param->body1).x,
-                shape2_max.y + 0.5*(shape1_max.y - shape1_min.y)+SMALL_DISTANCE};
-        body_set_centroid(param->body1, new_centroid);
-        vector_t new_velocity = {body_get_velocity(param->body1).x, 0};
-        body_set_velocity(param->body1, new_velocity);
-        vector_t force = vec_multiply(body_get_mass(param->body1),
-                                          *(vector_t *) param->aux);
-        body_add_force(param->body1, force);
-    } else {
-        if (!strcmp(entity_get_type(body_get_info(param->body2)),"TERRAIN")){
-            collision_info_t collision = find_collision(shape1,shape2);
-            if (collision.collided) {
-                if (fabs(collision.axis.y) < SMALL_VALUE){
-                
-                    if (body_get_centroid(param->body1).x <
-                            body_get_centroid(param->body2).x) {
-                                body_translate(param->body1,
-                                        vec_multiply(collision.overlap,
-                                            vec_negate(collision.axis)));
-                    } else {
-                            body_translate(param->body1,
-                                    vec_multiply(collision.overlap,
-                                        (collision.axis)));
-                    }
-                    vector_t old_velocity = body_get_velocity(param->body1);
-                    vector_t terrain_vel = body_get_velocity(param->body2);
-                    body_set_velocity(param->body1, (vector_t) {
-                            terrain_vel.x, old_velocity.y});
-                } else {
-                    body_translate(param->body1,
-                        vec_multiply(collision.overlap, collision.axis));
-                    vector_t old_velocity = body_get_velocity(param->body1);
-                    body_set_velocity(param->body1, (vector_t) {
-                            old_velocity.x, 0});
-                }
-            }
-        }
-    }
-    free(shape1);
-    free(shape2);
-}
-
 /**
  * Collision handler for a one way destrcutive collision, where the second
  * body is destroyed.
@@ -367,17 +577,3 @@ void create_physics_collision(scene_t *scene, double elasticity,
     create_collision(scene, body1, body2, physics_collision_handler,
                         elasticity_param, free);
 }
-
-void create_normal_collision(scene_t *scene, vector_t grav,
-                                    body_t *body1, body_t *body2) {
-    vector_t *grav_param = malloc(sizeof(vector_t));
-    *grav_param = grav;
-    list_t *bodies = list_init(2, body_free);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    normal_param_t *force_param = malloc(sizeof(normal_param_t));
-    *force_param = (normal_param_t) {normal_handler, body1,
-                                        body2, grav_param, false, free};
-    scene_add_bodies_force_creator(scene, normal_handler, force_param,
-                                        bodies, normal_param_free);
-}
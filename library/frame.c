@@ -1,3 +1,4 @@
+#include <math.h>
 #include <stdlib.h>
 #include "frame.h"
 
@@ -8,32 +9,92 @@
 #include "powerup.h"
 #include "sdl_wrapper.h"
 #include "shapelib.h"
+#include "solver.h"
 
 
 const int TERRAIN_HEIGHT = 50;
 const int PLATFORM_HEIGHT = 10;
 const int TERRAIN_PAD = 10;
-const vector_t NORMAL_GRAV = {0, 800};
+//How far apart, in pixels, two edges of terrain may be and still count as touching.
+const double TERRAIN_MERGE_TOLERANCE = 1e-6;
+//The most pieces of terrain a new piece is checked against for merging.
+#define MAX_TERRAIN_NEIGHBORS 16
 
 /**
- * Creates a block of terrain in the specified position
+ * Widens a piece of terrain that a new rectangle continues end to end,
+ * at the same height and of the same kind, so that the two act as one collider.
+ * A piece is not widened past the width of the scene's kill region.
+ * @param scene the scene to add the terrain to
+ * @param box the new rectangle
+ * @param one_way whether the new rectangle is a platform
+ * @return whether a piece was widened, in which case the rectangle needs no body
+ */
+bool extend_terrain(scene_t *scene, aabb_t box, bool one_way) {
+    terrain_t *terrain = scene_get_terrain(scene);
+    aabb_t local = terrain_local_box(terrain, box);
+    //Pieces grow to at most the kill region's width, so they still leave it
+    //and are culled, and they only ever cross a few columns of the terrain.
+    aabb_t region = scene_get_kill_region(scene);
+    double max_width = region.max.x - region.min.x;
+    const terrain_span_t *spans[MAX_TERRAIN_NEIGHBORS];
+    size_t count = terrain_find(terrain, aabb_expand(local, TERRAIN_MERGE_TOLERANCE),
+                                spans, MAX_TERRAIN_NEIGHBORS);
+    for (size_t i = 0; i < count; i++) {
+        aabb_t span = spans[i]->box;
+        bool level = fabs(span.min.y - local.min.y) <= TERRAIN_MERGE_TOLERANCE &&
+                     fabs(span.max.y - local.max.y) <= TERRAIN_MERGE_TOLERANCE;
+        bool touching = fabs(span.max.x - local.min.x) <= TERRAIN_MERGE_TOLERANCE ||
+                        fabs(local.max.x - span.min.x) <= TERRAIN_MERGE_TOLERANCE;
+        double width = fmax(span.max.x, local.max.x) - fmin(span.min.x, local.min.x);
+        body_t *body = spans[i]->body;
+        if (spans[i]->one_way == one_way && level && touching && width <= max_width &&
+                !body_is_removed(body)) {
+            aabb_t old = body_get_aabb(body);
+            scene_update_terrain(scene, spans[i],
+                                 (aabb_t) {{fmin(old.min.x, box.min.x), old.min.y},
+                                           {fmax(old.max.x, box.max.x), old.max.y}});
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Creates a solid rectangle of terrain, or widens the terrain it continues
  * @param scene the scene to add the terrain to
  * @param center vector_t to the center of the rectangular block
  * @param width width of the rectangle
  * @param height height of the rectangle
+ * @param type ENTITY_TERRAIN for a block, or ENTITY_PLATFORM for a one-way platform
  */
-void create_terrain_rect(scene_t *scene, vector_t center,
-                            double width, double height) {
-    entity_t *entity = entity_init("TERRAIN", true, false);
+void create_terrain_body(scene_t *scene, vector_t center, double width, double height,
+                         entity_type_t type) {
+    bool one_way = type == ENTITY_PLATFORM;
+    vector_t half = {width / 2, height / 2};
+    if (extend_terrain(scene, (aabb_t) {vec_subtract(center, half), vec_add(center, half)},
+                       one_way)) {
+        return;
+    }
     list_t *rect_coords = compute_rect_points(center, width, height);
-    body_t *body = body_init_with_info(rect_coords, INFINITY,
-                                            entity, entity_free);
+    body_t *body = body_init(rect_coords, INFINITY);
     rgb_color_t *black = malloc(sizeof(rgb_color_t));
     *black = BLACK;
     body_set_draw(body, sdl_draw_polygon, black, free);
-    scene_add_body(scene, body);
-    create_normal_collision(scene, NORMAL_GRAV, scene_get_body(scene,3), body);
-    create_terrain_collisions(scene, body);
+    entity_add(scene, body, type);
+    solver_add_terrain(scene, body, one_way);
+    create_terrain_culling(scene, body);
+}
+
+/**
+ * Creates a block of terrain in the specified position
+ * @param scene the scene to add the terrain to
+ * @param center vector_t to the center of the rectangular block
+ * @param width width of the rectangle
+ * @param height height of the rectangle
+ */
+void create_terrain_rect(scene_t *scene, vector_t center,
+                            double width, double height) {
+    create_terrain_body(scene, center, width, height, ENTITY_TERRAIN);
 }
 
 /**
@@ -45,16 +106,7 @@ void create_terrain_rect(scene_t *scene, vector_t center,
  */
 void create_platform(scene_t *scene, vector_t center,
                             double width, double height) {
-    entity_t *entity = entity_init("PLATFORM", true, false);
-    list_t *rect_coords = compute_rect_points(center, width, height);
-    body_t *body = body_init_with_info(rect_coords, INFINITY,
-                                            entity, entity_free);
-    rgb_color_t *black = malloc(sizeof(rgb_color_t));
-    *black = BLACK;
-    body_set_draw(body, sdl_draw_polygon, black, free);
-    scene_add_body(scene, body);
-    create_normal_collision(scene, NORMAL_GRAV, scene_get_body(scene,3), body);
-    create_terrain_collisions(scene, body);
+    create_terrain_body(scene, center, width, height, ENTITY_PLATFORM);
 }
 
 /**
@@ -196,7 +248,7 @@ void frame_spawn_random(scene_t *scene, vector_t frame, double frame_start,
                         double *score, list_t *achievements) {
     int frame_num;
 
-    frame_num = rand() % 7;
+    frame_num = scene_rand(scene) % 7;
     if (frame_num == 0) {
         frame_0(scene, frame, frame_start, score, achievements);
     }
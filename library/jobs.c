@@ -0,0 +1,232 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "jobs.h"
+
+size_t job_pool_chunks(size_t count, size_t grain) {
+    assert(grain > 0);
+    return (count + grain - 1) / grain;
+}
+
+//Runs the chunks [first, last) of a loop on the calling thread.
+void run_chunks_serially(size_t count, size_t grain, size_t first, size_t last,
+                         job_func_t func, void *aux) {
+    for (size_t chunk = first; chunk < last; chunk++) {
+        size_t start = chunk * grain;
+        size_t end = start + grain < count ? start + grain : count;
+        func(aux, start, end, chunk);
+    }
+}
+
+#ifdef _WIN32
+
+//No pthreads on Windows: the pool only remembers its size.
+typedef struct job_pool {
+    size_t num_threads;
+} job_pool_t;
+
+job_pool_t *job_pool_init(size_t num_threads) {
+    assert(num_threads >= 1);
+    job_pool_t *pool = malloc(sizeof(job_pool_t));
+    assert(pool != NULL);
+    pool->num_threads = 1;
+    return pool;
+}
+
+void job_pool_free(job_pool_t *pool) {
+    free(pool);
+}
+
+size_t job_pool_threads(job_pool_t *pool) {
+    return 1;
+}
+
+void job_pool_parallel_for(job_pool_t *pool, size_t count, size_t grain,
+                           job_func_t func, void *aux) {
+    run_chunks_serially(count, grain, 0, job_pool_chunks(count, grain), func, aux);
+}
+
+#else
+
+#include <pthread.h>
+
+//The chunks a thread has left: the owner takes from next, thieves take from end.
+typedef struct {
+    pthread_mutex_t lock;
+    size_t next;
+    size_t end;
+} job_queue_t;
+
+typedef struct job_pool job_pool_t;
+
+//What a worker thread needs to know about its pool.
+typedef struct {
+    job_pool_t *pool;
+    size_t id;
+} worker_t;
+
+typedef struct job_pool {
+    size_t num_threads;
+    pthread_t *threads;
+    worker_t *workers;
+    job_queue_t *queues;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    size_t generation;
+    size_t busy;
+    bool stopping;
+    job_func_t func;
+    void *aux;
+    size_t count;
+    size_t grain;
+} job_pool_t;
+
+//Takes the next chunk from a thread's own queue, or steals one from another queue.
+//Returns false once every queue is empty.
+bool take_chunk(job_pool_t *pool, size_t id, size_t *chunk) {
+    job_queue_t *own = &pool->queues[id];
+    bool found = false;
+    pthread_mutex_lock(&own->lock);
+    if (own->next < own->end) {
+        *chunk = own->next;
+        own->next++;
+        found = true;
+    }
+    pthread_mutex_unlock(&own->lock);
+    for (size_t i = 1; i < pool->num_threads && !found; i++) {
+        job_queue_t *victim = &pool->queues[(id + i) % pool->num_threads];
+        pthread_mutex_lock(&victim->lock);
+        if (victim->next < victim->end) {
+            victim->end--;
+            *chunk = victim->end;
+            found = true;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+    return found;
+}
+
+//Runs chunks of the current loop until there are none left anywhere.
+void run_chunks(job_pool_t *pool, size_t id) {
+    size_t chunk;
+    while (take_chunk(pool, id, &chunk)) {
+        run_chunks_serially(pool->count, pool->grain, chunk, chunk + 1,
+                            pool->func, pool->aux);
+    }
+}
+
+//Main loop of a worker thread: waits for a loop, helps run it, and reports back.
+void *worker_main(void *arg) {
+    worker_t *worker = arg;
+    job_pool_t *pool = worker->pool;
+    size_t seen = 0;
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stopping && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_chunks(pool, worker->id);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->busy--;
+        if (pool->busy == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+job_pool_t *job_pool_init(size_t num_threads) {
+    assert(num_threads >= 1);
+    job_pool_t *pool = malloc(sizeof(job_pool_t));
+    assert(pool != NULL);
+    pool->num_threads = num_threads;
+    pool->threads = malloc(sizeof(pthread_t) * num_threads);
+    pool->workers = malloc(sizeof(worker_t) * num_threads);
+    pool->queues = malloc(sizeof(job_queue_t) * num_threads);
+    assert(pool->threads != NULL && pool->workers != NULL && pool->queues != NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->generation = 0;
+    pool->busy = 0;
+    pool->stopping = false;
+    for (size_t i = 0; i < num_threads; i++) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+        pool->queues[i].next = 0;
+        pool->queues[i].end = 0;
+    }
+    //Thread 0 is whichever thread calls job_pool_parallel_for().
+    for (size_t i = 1; i < num_threads; i++) {
+        pool->workers[i] = (worker_t) {pool, i};
+        int error = pthread_create(&pool->threads[i], NULL, worker_main,
+                                   &pool->workers[i]);
+        assert(error == 0);
+    }
+    return pool;
+}
+
+void job_pool_free(job_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (size_t i = 0; i < pool->num_threads; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool->queues);
+    free(pool);
+}
+
+size_t job_pool_threads(job_pool_t *pool) {
+    return pool == NULL ? 1 : pool->num_threads;
+}
+
+void job_pool_parallel_for(job_pool_t *pool, size_t count, size_t grain,
+                           job_func_t func, void *aux) {
+    size_t chunks = job_pool_chunks(count, grain);
+    if (pool == NULL || pool->num_threads == 1 || chunks <= 1) {
+        run_chunks_serially(count, grain, 0, chunks, func, aux);
+        return;
+    }
+    //Give each thread an even, contiguous share of the chunks to start with.
+    for (size_t i = 0; i < pool->num_threads; i++) {
+        pool->queues[i].next = chunks * i / pool->num_threads;
+        pool->queues[i].end = chunks * (i + 1) / pool->num_threads;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->func = func;
+    pool->aux = aux;
+    pool->count = count;
+    pool->grain = grain;
+    pool->busy = pool->num_threads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_chunks(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+#endif
@@ -31,20 +31,38 @@ list_t *list_init(size_t initial_size, free_func_t freer) {
     return list;
 }
 
+//Moves the list's elements into a new array with the given capacity.
+void resize(list_t *list, size_t capacity) {
+    void **new_data = malloc(sizeof(void *) * capacity);
+    assert(new_data != NULL);
+    for (int i = 0; i < list->size; i++) {
+        new_data[i] = list->data[i];
+    }
+    free(list->data);
+    list->data = new_data;
+    list->capacity = capacity;
+}
+
 void ensure_capacity(list_t *list) {
     if (list->size == list->capacity) {
-        void **new_data = malloc(sizeof(void *) * (list->capacity * RESIZE_FACTOR));
-        for (int i = 0; i < list->size; i++) {
-            new_data[i] = list->data[i];
-        }
-        list->data = new_data;
-        list->capacity *= 2; 
+        resize(list, list->capacity * RESIZE_FACTOR);
+    }
+}
+
+void list_reserve(list_t *list, size_t extra) {
+    size_t needed = list->size + extra;
+    if (needed > list->capacity) {
+        //Grow at least geometrically, so small reserves each tick stay amortized O(1).
+        size_t doubled = list->capacity * RESIZE_FACTOR;
+        resize(list, needed > doubled ? needed : doubled);
     }
 }
 
 void list_free(list_t *list) {
-    for (size_t i = 0; i < list->size; i++) {
-        list->freer(list->data[i]);
+    if (list->freer != NULL) {
+        for (size_t i = 0; i < list->size; i++) {
+            list->freer(list->data[i]);
+        }
     }
     free(list->data);
     free(list);
@@ -54,6 +72,10 @@ size_t list_size(list_t *list) {
     return list->size;
 }
 
+size_t list_capacity(list_t *list) {
+    return list->capacity;
+}
+
 void *list_get(list_t *list, size_t index) {
     assert(index >= 0 && index < list->size);
     return list->data[index];
@@ -76,3 +98,16 @@ void list_add(list_t *list, void *value) {
     list->data[list->size] = value;
     list->size++;
 }
+
+void list_filter(list_t *list, keep_func_t keep) {
+    size_t kept = 0;
+    for (size_t i = 0; i < list->size; i++) {
+        if (keep(list->data[i])) {
+            list->data[kept] = list->data[i];
+            kept++;
+        } else if (list->freer != NULL) {
+            list->freer(list->data[i]);
+        }
+    }
+    list->size = kept;
+}
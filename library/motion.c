@@ -0,0 +1,78 @@
+#include <math.h>
+#include "motion.h"
+
+//Drops a seek whose target is being removed, before the target is freed.
+bool motion_keep(motion_t *motion) {
+    return motion->type != MOTION_SEEK || !body_is_removed(motion->target);
+}
+
+const component_kind_t MOTION = {
+    .name = "motion",
+    .size = sizeof(motion_t),
+    .keep = (keep_func_t) motion_keep
+};
+
+void motion_add_oscillation(scene_t *scene, body_t *body, vector_t amplitude,
+                            double frequency) {
+    motion_t *motion = scene_add_component(scene, body, &MOTION);
+    motion->type = MOTION_OSCILLATE;
+    motion->amplitude = amplitude;
+    motion->frequency = frequency;
+}
+
+void motion_add_acceleration(scene_t *scene, body_t *body, vector_t velocity,
+                             vector_t acceleration) {
+    motion_t *motion = scene_add_component(scene, body, &MOTION);
+    motion->type = MOTION_ACCELERATE;
+    motion->velocity = velocity;
+    motion->acceleration = acceleration;
+}
+
+void motion_add_seek(scene_t *scene, body_t *body, body_t *target, double speed) {
+    motion_t *motion = scene_add_component(scene, body, &MOTION);
+    motion->type = MOTION_SEEK;
+    motion->target = target;
+    motion->speed = speed;
+}
+
+//Computes where a motion's path is at a time, relative to where it started.
+vector_t motion_offset(motion_t *motion, double time) {
+    switch (motion->type) {
+        case MOTION_OSCILLATE:
+            return vec_multiply(cos(motion->frequency * time) - 1, motion->amplitude);
+        case MOTION_ACCELERATE:
+            return vec_add(vec_multiply(time, motion->velocity),
+                           vec_multiply(time * time / 2, motion->acceleration));
+        default:
+            return VEC_ZERO;
+    }
+}
+
+//Computes how far a body moves along its path over the next dt seconds.
+vector_t motion_displacement(body_t *body, motion_t *motion, double dt) {
+    if (motion->type != MOTION_SEEK) {
+        return vec_subtract(motion_offset(motion, motion->time + dt),
+                            motion_offset(motion, motion->time));
+    }
+    vector_t to_target = vec_subtract(body_get_centroid(motion->target),
+                                      body_get_centroid(body));
+    double distance = vec_mag(to_target);
+    //Stop on the target rather than stepping past it.
+    double step = fmin(motion->speed * dt, distance);
+    return distance > 0 ? vec_multiply(step / distance, to_target) : VEC_ZERO;
+}
+
+void motion_step(scene_t *scene, double dt) {
+    if (dt <= 0) {
+        return;
+    }
+    component_pool_t *pool = scene_get_components(scene, &MOTION);
+    body_t **bodies = component_pool_bodies(pool);
+    motion_t *motions = component_pool_data(pool);
+    for (size_t i = 0; i < component_pool_size(pool); i++) {
+        //Without forces, body_tick() moves the body by exactly its velocity times dt.
+        vector_t displacement = motion_displacement(bodies[i], &motions[i], dt);
+        body_set_velocity(bodies[i], vec_multiply(1 / dt, displacement));
+        motions[i].time += dt;
+    }
+}
@@ -0,0 +1,223 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pair_cache.h"
+
+const size_t DEFAULT_CACHE_CAPACITY = 8;
+const size_t CACHE_RESIZE_FACTOR = 2;
+
+typedef struct pair_cache {
+    //The pairs, packed so they can be walked and copied as one array.
+    contact_t *contacts;
+    size_t size;
+    size_t capacity;
+    //Open-addressed hash table mapping a pair's key to one more than the index
+    //of its contact, or 0 for an empty slot. The number of slots is a power
+    //of two at least twice capacity, so probes stay short.
+    size_t *slots;
+    size_t num_slots;
+} pair_cache_t;
+
+pair_cache_t *pair_cache_init(void) {
+    pair_cache_t *cache = malloc(sizeof(pair_cache_t));
+    assert(cache != NULL);
+    cache->contacts = malloc(sizeof(contact_t) * DEFAULT_CACHE_CAPACITY);
+    cache->num_slots = DEFAULT_CACHE_CAPACITY * CACHE_RESIZE_FACTOR;
+    cache->slots = calloc(cache->num_slots, sizeof(size_t));
+    assert(cache->contacts != NULL && cache->slots != NULL);
+    cache->size = 0;
+    cache->capacity = DEFAULT_CACHE_CAPACITY;
+    return cache;
+}
+
+void pair_cache_free(pair_cache_t *cache) {
+    free(cache->contacts);
+    free(cache->slots);
+    free(cache);
+}
+
+size_t pair_cache_size(pair_cache_t *cache) {
+    return cache->size;
+}
+
+const contact_t *pair_cache_contacts(pair_cache_t *cache) {
+    return cache->contacts;
+}
+
+size_t pair_cache_bytes(pair_cache_t *cache) {
+    return sizeof(contact_t) * cache->capacity + sizeof(size_t) * cache->num_slots;
+}
+
+//Finds the slot a pair of body IDs hashes to first. The smaller ID goes first.
+size_t pair_home(pair_cache_t *cache, size_t id1, size_t id2) {
+    uint64_t key = ((uint64_t) id1 << 32) ^ (uint64_t) id2;
+    key *= 0x9E3779B97F4A7C15ULL;
+    return (size_t) (key ^ (key >> 32)) & (cache->num_slots - 1);
+}
+
+size_t contact_home(pair_cache_t *cache, contact_t *contact) {
+    return pair_home(cache, body_get_id(contact->body1), body_get_id(contact->body2));
+}
+
+//Finds the slot holding a pair, or the empty slot where it would go.
+size_t pair_find_slot(pair_cache_t *cache, size_t id1, size_t id2) {
+    size_t slot = pair_home(cache, id1, id2);
+    while (cache->slots[slot] != 0) {
+        contact_t *contact = &cache->contacts[cache->slots[slot] - 1];
+        if (body_get_id(contact->body1) == id1 && body_get_id(contact->body2) == id2) {
+            return slot;
+        }
+        slot = (slot + 1) & (cache->num_slots - 1);
+    }
+    return slot;
+}
+
+//Refills the hash table from the packed contacts.
+void pair_cache_rehash(pair_cache_t *cache) {
+    memset(cache->slots, 0, sizeof(size_t) * cache->num_slots);
+    for (size_t i = 0; i < cache->size; i++) {
+        contact_t *contact = &cache->contacts[i];
+        size_t slot = pair_find_slot(cache, body_get_id(contact->body1),
+                                     body_get_id(contact->body2));
+        cache->slots[slot] = i + 1;
+    }
+}
+
+//Gives the cache room for at least the given number of pairs.
+void pair_cache_reserve(pair_cache_t *cache, size_t capacity) {
+    if (capacity <= cache->capacity) {
+        return;
+    }
+    cache->capacity = capacity;
+    cache->contacts = realloc(cache->contacts, sizeof(contact_t) * cache->capacity);
+    size_t num_slots = cache->num_slots;
+    while (num_slots < capacity * CACHE_RESIZE_FACTOR) {
+        num_slots *= CACHE_RESIZE_FACTOR;
+    }
+    if (num_slots != cache->num_slots) {
+        cache->num_slots = num_slots;
+        cache->slots = realloc(cache->slots, sizeof(size_t) * num_slots);
+    }
+    assert(cache->contacts != NULL && cache->slots != NULL);
+    pair_cache_rehash(cache);
+}
+
+//Empties a slot, shifting back later entries of the same probe run
+//so that lookups never stop early at the hole.
+void pair_clear_slot(pair_cache_t *cache, size_t slot) {
+    size_t mask = cache->num_slots - 1;
+    size_t next = slot;
+    while (true) {
+        next = (next + 1) & mask;
+        if (cache->slots[next] == 0) {
+            break;
+        }
+        size_t home = contact_home(cache, &cache->contacts[cache->slots[next] - 1]);
+        //Move the entry back unless its home lies cyclically in (slot, next].
+        bool stays = slot <= next ? (slot < home && home <= next)
+                                  : (slot < home || home <= next);
+        if (!stays) {
+            cache->slots[slot] = cache->slots[next];
+            slot = next;
+        }
+    }
+    cache->slots[slot] = 0;
+}
+
+//Removes the pair in a slot, moving the last pair into its place.
+void pair_cache_remove(pair_cache_t *cache, size_t slot) {
+    size_t index = cache->slots[slot] - 1;
+    pair_clear_slot(cache, slot);
+    cache->size--;
+    if (index == cache->size) {
+        return;
+    }
+    contact_t *last = &cache->contacts[cache->size];
+    size_t last_slot = pair_find_slot(cache, body_get_id(last->body1),
+                                      body_get_id(last->body2));
+    cache->contacts[index] = *last;
+    cache->slots[last_slot] = index + 1;
+}
+
+contact_t *pair_cache_get(pair_cache_t *cache, body_t *body1, body_t *body2) {
+    size_t id1 = body_get_id(body1);
+    size_t id2 = body_get_id(body2);
+    size_t slot = id1 < id2 ? pair_find_slot(cache, id1, id2)
+                            : pair_find_slot(cache, id2, id1);
+    if (cache->slots[slot] == 0) {
+        return NULL;
+    }
+    return &cache->contacts[cache->slots[slot] - 1];
+}
+
+contact_event_t pair_cache_update(pair_cache_t *cache, body_t *body1, body_t *body2,
+                                  bool near, collision_info_t collision) {
+    //Store the pair with the smaller ID first, flipping the axes to match.
+    bool flipped = body_get_id(body2) < body_get_id(body1);
+    if (flipped) {
+        body_t *temp = body1;
+        body1 = body2;
+        body2 = temp;
+        collision.axis = vec_negate(collision.axis);
+    }
+    size_t slot = pair_find_slot(cache, body_get_id(body1), body_get_id(body2));
+    if (!near) {
+        if (cache->slots[slot] == 0) {
+            return CONTACT_NONE;
+        }
+        bool touching = cache->contacts[cache->slots[slot] - 1].touching;
+        pair_cache_remove(cache, slot);
+        return touching ? CONTACT_EXIT : CONTACT_NONE;
+    }
+    if (cache->slots[slot] == 0) {
+        if (cache->size == cache->capacity) {
+            pair_cache_reserve(cache, cache->capacity * CACHE_RESIZE_FACTOR);
+            slot = pair_find_slot(cache, body_get_id(body1), body_get_id(body2));
+        }
+        cache->contacts[cache->size] = (contact_t) {body1, body2, false, VEC_ZERO, 0,
+                                                    VEC_ZERO, {0}, {0}};
+        cache->slots[slot] = cache->size + 1;
+        cache->size++;
+    }
+    contact_t *contact = &cache->contacts[cache->slots[slot] - 1];
+    bool was_touching = contact->touching;
+    contact->touching = collision.collided;
+    if (collision.collided) {
+        contact->axis = collision.axis;
+        contact->overlap = collision.overlap;
+        return was_touching ? CONTACT_STAY : CONTACT_ENTER;
+    }
+    if (collision.axis.x != 0 || collision.axis.y != 0) {
+        contact->separating_axis = collision.axis;
+    }
+    contact->manifold.count = 0;
+    memset(contact->impulses, 0, sizeof(contact->impulses));
+    return was_touching ? CONTACT_EXIT : CONTACT_NONE;
+}
+
+void pair_cache_filter(pair_cache_t *cache, keep_func_t keep) {
+    size_t kept = 0;
+    for (size_t i = 0; i < cache->size; i++) {
+        contact_t *contact = &cache->contacts[i];
+        if (!keep(contact->body1) || !keep(contact->body2)) {
+            continue;
+        }
+        cache->contacts[kept] = *contact;
+        kept++;
+    }
+    if (kept == cache->size) {
+        return;
+    }
+    cache->size = kept;
+    pair_cache_rehash(cache);
+}
+
+void pair_cache_set(pair_cache_t *cache, const contact_t *contacts, size_t count) {
+    pair_cache_reserve(cache, count);
+    if (count > 0) {
+        memcpy(cache->contacts, contacts, sizeof(contact_t) * count);
+    }
+    cache->size = count;
+    pair_cache_rehash(cache);
+}
@@ -46,3 +46,24 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point) {
     }
     polygon_translate(polygon, point);
 }
+
+bool polygon_is_rect(list_t *polygon) {
+    if (list_size(polygon) != 4) {
+        return false;
+    }
+    //The edges must alternate between horizontal and vertical.
+    vector_t first = vec_subtract(*(vector_t *)list_get(polygon, 1),
+                                  *(vector_t *)list_get(polygon, 0));
+    bool horizontal = first.y == 0;
+    for (size_t i = 0; i < 4; i++) {
+        vector_t cur = *(vector_t *)list_get(polygon, i);
+        vector_t next = *(vector_t *)list_get(polygon, (i+1) % 4);
+        vector_t edge = vec_subtract(next, cur);
+        bool along = horizontal ? edge.y == 0 && edge.x != 0 : edge.x == 0 && edge.y != 0;
+        if (!along) {
+            return false;
+        }
+        horizontal = !horizontal;
+    }
+    return true;
+}
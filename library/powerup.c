@@ -21,8 +21,8 @@ const char* JUMP = "static/jump_powerup.png";
 const char *COIN = "static/coin_spritesheet.png";
 
 //Removes the functionality of the previous powerup.
-void remove_old_powerup(char *powerup, vector_t *scroll_speed) {
-    if (!strcmp(powerup, "SLOW")) {
+void remove_old_powerup(powerup_t powerup, vector_t *scroll_speed) {
+    if (powerup == POWERUP_SLOW) {
         scroll_speed->x = 2 * scroll_speed->x;
     }
     //for MAGNET, all remaining on-screen coins will be magnetized, but newer ones won't.
@@ -36,48 +36,20 @@ typedef struct powerup_info {
     list_t *achievements;
 } powerup_info_t;
 
-typedef struct param {
-    double constant;
-    body_t *body1;
-    body_t *body2;
-} param_t;
-
-//The gravity creator between a player with the magnet powerup and coins.
-void magnet_gravity_creator(param_t *aux){
-    vector_t r = vec_subtract(body_get_centroid(aux->body1),
-                              body_get_centroid(aux->body2));
-    double mass_product = body_get_mass(aux->body1)* body_get_mass(aux->body2);
-    vector_t force = VEC_ZERO;
-    force = vec_multiply(-aux->constant*mass_product / pow(sqrt(vec_dot(r,r)), 3.0) , r);
-    body_add_force(aux->body1, force);
-}
-
-//Attracts coins to a player with the magnet powerup using one-way gravity.
-void create_magnet_gravity(scene_t *scene, double G, body_t *body1, body_t *body2){
-    param_t *force_param = malloc(sizeof(param_t));
-    *force_param = (param_t){G, body1, body2};
-    list_t *bodies = list_init(2, body_free);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    scene_add_bodies_force_creator(scene, magnet_gravity_creator, force_param, bodies, 
-                                   free);
-}
-
 //Collision handler for when player collects a magnet powerup. Attracts coins to player.
 void magnet_handler(body_t *player, body_t *powerup, vector_t axis, void *aux) {
     powerup_info_t *info = aux;
     *(double *)list_get(info->achievements, 3) =
         *(double *)list_get(info->achievements, 3) + 1;
     scene_t *scene = info->scene;
-    player_entity_t *entity = body_get_info(player);
-    if (strcmp(entity_get_powerup(entity), "MAGNET")) {
+    player_state_t *entity = entity_get_player_state(info->scene, player);
+    if (entity_get_powerup(entity) != POWERUP_MAGNET) {
         remove_old_powerup(entity_get_powerup(entity), info->scroll_speed);
-        entity_set_powerup(entity, "MAGNET");
-        for (size_t i = 0; i < scene_bodies(info->scene); i++) {
-            body_t *body = scene_get_body(scene, i);
-            if (!strcmp(entity_get_type(body_get_info(body)), "COIN")) {
-                create_magnet_gravity(scene, GRAVITY_CONST, body, player);
-            }
+        entity_set_powerup(entity, POWERUP_MAGNET);
+        component_pool_t *coins = scene_get_bodies_of_type(scene, ENTITY_COIN);
+        body_t **bodies = component_pool_bodies(coins);
+        for (size_t i = 0; i < component_pool_size(coins); i++) {
+            create_one_way_gravity(scene, GRAVITY_CONST, bodies[i], player);
         }
     }
     body_remove(powerup);
@@ -89,10 +61,10 @@ void slow_handler(body_t *player, body_t *powerup, vector_t axis, void *aux) {
     *(double *)list_get(info->achievements, 3) =
         *(double *)list_get(info->achievements, 3) + 1;
     vector_t *scroll_speed = info->scroll_speed;
-    player_entity_t *entity = body_get_info(player);
-    if (strcmp(entity_get_powerup(entity), "SLOW")) {
+    player_state_t *entity = entity_get_player_state(info->scene, player);
+    if (entity_get_powerup(entity) != POWERUP_SLOW) {
         remove_old_powerup(entity_get_powerup(entity), scroll_speed);
-        entity_set_powerup(entity, "SLOW");
+        entity_set_powerup(entity, POWERUP_SLOW);
         scroll_speed->x = 0.5 * scroll_speed->x;
     }
     body_remove(powerup);
@@ -103,10 +75,10 @@ void jump_handler(body_t *player, body_t *powerup, vector_t axis, void *aux) {
     powerup_info_t *info = aux;
     *(double *)list_get(info->achievements, 3) =
         *(double *)list_get(info->achievements, 3) + 1;
-    player_entity_t *entity = body_get_info(player);
-    if (strcmp(entity_get_powerup(entity), "JUMP")) {
+    player_state_t *entity = entity_get_player_state(info->scene, player);
+    if (entity_get_powerup(entity) != POWERUP_JUMP) {
         remove_old_powerup(entity_get_powerup(entity), info->scroll_speed);
-        entity_set_powerup(entity, "JUMP");
+        entity_set_powerup(entity, POWERUP_JUMP);
     }
     body_remove(powerup);
 }
@@ -123,13 +95,11 @@ void coin_handler(body_t *player, body_t *coin, vector_t axis, void *aux) {
 //Creates the body of a powerup and adds it to the scene.
 body_t *spawn_powerup(scene_t *scene, vector_t MIN, vector_t MAX, powerup_info_t *info) {
     vector_t center = {MAX.x + POWERUP_RADIUS,
-        rand()%(int)((MAX.y - MIN.y - 2*POWERUP_PADDING) + POWERUP_PADDING)};
-    entity_t *entity = entity_init("POWERUP", true, false);
+        scene_rand(scene)%(int)((MAX.y - MIN.y - 2*POWERUP_PADDING) + POWERUP_PADDING)};
     list_t *powerup_coords = compute_rect_points(center, 2*POWERUP_RADIUS,
                                                  2*POWERUP_RADIUS);
-    body_t *powerup = body_init_with_info(powerup_coords, POWERUP_MASS, entity,
-                                          entity_free);
-    scene_add_body(scene, powerup);
+    body_t *powerup = body_init(powerup_coords, POWERUP_MASS);
+    entity_add(scene, powerup, ENTITY_POWERUP);
     return powerup;
 }
 
@@ -143,22 +113,25 @@ void powerup_spawn_random(scene_t *scene, vector_t MIN, vector_t MAX,
     int percent_magnet = 20;
     int percent_slow = 60;
     int percent_jump = 100;
-    int random_powerup = rand()%percent_max;
+    int random_powerup = scene_rand(scene)%percent_max;
     body_t *player = scene_get_body(scene, 3);
     body_t *powerup = spawn_powerup(scene, MIN, MAX, info);
-    create_bounds_collisions(scene, powerup, POWERUP_RADIUS);
+    create_bounds_culling(scene, powerup, POWERUP_RADIUS);
     if (random_powerup <= percent_magnet) {
-        sprite_t *magnet_info = sprite_animated(MAGNET, 1, 1, 1);
+        sprite_t *magnet_info = sprite_animated(scene_get_context(scene),
+                                                MAGNET, 1, 1, 1);
         body_set_draw(powerup, (draw_func_t) sdl_draw_animated, magnet_info, sprite_free);
         create_collision(scene, player, powerup, magnet_handler, info, free);
     }
     else if (random_powerup <= percent_slow) {
-        sprite_t *slow_info = sprite_animated(SLOW, 1, 1, 1);
+        sprite_t *slow_info = sprite_animated(scene_get_context(scene),
+                                              SLOW, 1, 1, 1);
         body_set_draw(powerup, (draw_func_t) sdl_draw_animated, slow_info, sprite_free);
         create_collision(scene, player, powerup, slow_handler, info, free);
     }
     else if (random_powerup <= percent_jump) {
-        sprite_t *jump_info = sprite_animated(JUMP, 1, 1, 1);
+        sprite_t *jump_info = sprite_animated(scene_get_context(scene),
+                                              JUMP, 1, 1, 1);
         body_set_draw(powerup, (draw_func_t) sdl_draw_animated, jump_info, sprite_free);
         create_collision(scene, player, powerup, jump_handler, info, free);
     }
@@ -170,16 +143,16 @@ void powerup_spawn_coin(scene_t *scene, vector_t center, double *score,
     powerup_info_t *info = malloc(sizeof(powerup_info_t));
     info->score = score;
     info->achievements = achievements;
-    entity_t *entity = entity_init("COIN", true, false);
     list_t *coin_coords = compute_rect_points(center, 2*POWERUP_RADIUS,
                                                  2*POWERUP_RADIUS);
-    body_t *coin = body_init_with_info(coin_coords, POWERUP_MASS, entity,
-                                          entity_free);
-    scene_add_body(scene, coin);
-    sprite_t *coin_info = sprite_animated(COIN, 1, 6, 6);
+    body_t *coin = body_init(coin_coords, POWERUP_MASS);
+    entity_add(scene, coin, ENTITY_COIN);
+    sprite_t *coin_info = sprite_animated(scene_get_context(scene),
+                                          COIN, 1, 6, 6);
     body_set_draw(coin, (draw_func_t) sdl_draw_animated, coin_info, sprite_free);
     create_collision(scene, player, coin, coin_handler, info, free);
-    if (!strcmp(entity_get_powerup(body_get_info(player)), "MAGNET")) {
-        create_magnet_gravity(scene, GRAVITY_CONST, coin, player);
+    create_terrain_culling(scene, coin);
+    if (entity_get_powerup(entity_get_player_state(scene, player)) == POWERUP_MAGNET) {
+        create_one_way_gravity(scene, GRAVITY_CONST, coin, player);
     }
 }
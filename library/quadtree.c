@@ -0,0 +1,196 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "quadtree.h"
+
+const size_t DEFAULT_QUADTREE_CAPACITY = 16;
+const size_t QUADTREE_RESIZE_FACTOR = 2;
+//A square with this many bodies or fewer is not split any further.
+const size_t QUADTREE_LEAF_SIZE = 4;
+//Bodies at (nearly) the same point would otherwise be split forever.
+#define QUADTREE_MAX_DEPTH 32
+
+//A body's centroid and mass, copied when the tree is built.
+typedef struct {
+    vector_t position;
+    double mass;
+    body_t *body;
+} mass_point_t;
+
+typedef struct {
+    vector_t center;
+    double half_size;
+    double mass;
+    vector_t center_of_mass;
+    //The node's bodies are points[first] to points[first + count - 1].
+    size_t first;
+    size_t count;
+    bool leaf;
+    //Indices of the child squares, or 0 for an empty quadrant.
+    //The root is node 0, so it is never a child.
+    size_t children[4];
+} quad_node_t;
+
+typedef struct quadtree {
+    mass_point_t *points;
+    size_t num_points;
+    quad_node_t *nodes;
+    size_t num_nodes;
+    size_t capacity;
+} quadtree_t;
+
+//Moves the points on the low side of a split to the front
+//and returns how many there are.
+size_t partition_points(mass_point_t *points, size_t count, bool by_x, double split) {
+    size_t low = 0;
+    for (size_t i = 0; i < count; i++) {
+        double coordinate = by_x ? points[i].position.x : points[i].position.y;
+        if (coordinate < split) {
+            mass_point_t temp = points[low];
+            points[low] = points[i];
+            points[i] = temp;
+            low++;
+        }
+    }
+    return low;
+}
+
+//Adds the node for a square and, unless it is small enough to be a leaf,
+//its children. The points in the square are reordered by quadrant.
+size_t quadtree_build(quadtree_t *tree, size_t first, size_t count, vector_t center,
+                      double half_size, size_t depth) {
+    if (tree->num_nodes == tree->capacity) {
+        tree->capacity *= QUADTREE_RESIZE_FACTOR;
+        tree->nodes = realloc(tree->nodes, sizeof(quad_node_t) * tree->capacity);
+        assert(tree->nodes != NULL);
+    }
+    size_t index = tree->num_nodes++;
+    quad_node_t node = {center, half_size, 0, VEC_ZERO, first, count, true, {0}};
+    vector_t moment = VEC_ZERO;
+    for (size_t i = first; i < first + count; i++) {
+        node.mass += tree->points[i].mass;
+        moment = vec_add(moment, vec_multiply(tree->points[i].mass,
+                                              tree->points[i].position));
+    }
+    node.center_of_mass = node.mass > 0 ? vec_multiply(1 / node.mass, moment) : center;
+
+    if (count > QUADTREE_LEAF_SIZE && depth < QUADTREE_MAX_DEPTH) {
+        node.leaf = false;
+        mass_point_t *points = &tree->points[first];
+        size_t bottom = partition_points(points, count, false, center.y);
+        size_t bottom_left = partition_points(points, bottom, true, center.x);
+        size_t top_left = partition_points(&points[bottom], count - bottom, true,
+                                           center.x);
+        //Quadrants in order: bottom left, bottom right, top left, top right.
+        size_t starts[4] = {0, bottom_left, bottom, bottom + top_left};
+        size_t counts[4] = {bottom_left, bottom - bottom_left, top_left,
+                            count - bottom - top_left};
+        double quarter = half_size / 2;
+        for (size_t i = 0; i < 4; i++) {
+            if (counts[i] == 0) {
+                continue;
+            }
+            vector_t child_center = {center.x + (i % 2 == 0 ? -quarter : quarter),
+                                     center.y + (i < 2 ? -quarter : quarter)};
+            node.children[i] = quadtree_build(tree, first + starts[i], counts[i],
+                                              child_center, quarter, depth + 1);
+        }
+    }
+    //Building the children may have moved the nodes.
+    tree->nodes[index] = node;
+    return index;
+}
+
+quadtree_t *quadtree_init(body_t **bodies, size_t count) {
+    quadtree_t *tree = malloc(sizeof(quadtree_t));
+    assert(tree != NULL);
+    tree->points = malloc(sizeof(mass_point_t) * (count + 1));
+    tree->capacity = DEFAULT_QUADTREE_CAPACITY;
+    tree->nodes = malloc(sizeof(quad_node_t) * tree->capacity);
+    assert(tree->points != NULL && tree->nodes != NULL);
+    tree->num_points = count;
+    tree->num_nodes = 0;
+    if (count == 0) {
+        return tree;
+    }
+
+    vector_t min = {INFINITY, INFINITY};
+    vector_t max = {-INFINITY, -INFINITY};
+    for (size_t i = 0; i < count; i++) {
+        vector_t position = body_get_centroid(bodies[i]);
+        tree->points[i] = (mass_point_t) {position, body_get_mass(bodies[i]), bodies[i]};
+        min.x = fmin(min.x, position.x);
+        min.y = fmin(min.y, position.y);
+        max.x = fmax(max.x, position.x);
+        max.y = fmax(max.y, position.y);
+    }
+    vector_t center = vec_multiply(0.5, vec_add(min, max));
+    double half_size = fmax(max.x - min.x, max.y - min.y) / 2;
+    quadtree_build(tree, 0, count, center, half_size, 0);
+    return tree;
+}
+
+void quadtree_free(quadtree_t *tree) {
+    free(tree->points);
+    free(tree->nodes);
+    free(tree);
+}
+
+size_t quadtree_nodes(quadtree_t *tree) {
+    return tree->num_nodes;
+}
+
+//Computes the pull of a point mass on a body at a given position.
+vector_t point_gravity(vector_t position, double mass, vector_t source,
+                       double source_mass, double G, double cutoff) {
+    vector_t r = vec_subtract(position, source);
+    double distance = sqrt(vec_dot(r, r));
+    if (distance <= cutoff) {
+        return VEC_ZERO;
+    }
+    return vec_multiply(-G * mass * source_mass / (distance * distance * distance), r);
+}
+
+vector_t quadtree_gravity(quadtree_t *tree, body_t *body, double G, double theta,
+                          double cutoff) {
+    vector_t force = VEC_ZERO;
+    if (tree->num_nodes == 0) {
+        return force;
+    }
+    vector_t position = body_get_centroid(body);
+    double mass = body_get_mass(body);
+    //Each level visited leaves at most 3 siblings on the stack.
+    size_t stack[3 * QUADTREE_MAX_DEPTH + 4];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        quad_node_t *node = &tree->nodes[stack[--top]];
+        if (node->leaf) {
+            for (size_t i = node->first; i < node->first + node->count; i++) {
+                mass_point_t *point = &tree->points[i];
+                if (point->body == body) {
+                    continue;
+                }
+                force = vec_add(force, point_gravity(position, mass, point->position,
+                                                     point->mass, G, cutoff));
+            }
+            continue;
+        }
+        //Never approximate a square containing the body, or it would pull itself.
+        bool outside = fabs(position.x - node->center.x) > node->half_size ||
+                       fabs(position.y - node->center.y) > node->half_size;
+        vector_t r = vec_subtract(position, node->center_of_mass);
+        if (outside && 2 * node->half_size < theta * sqrt(vec_dot(r, r))) {
+            force = vec_add(force, point_gravity(position, mass, node->center_of_mass,
+                                                 node->mass, G, cutoff));
+            continue;
+        }
+        for (size_t i = 0; i < 4; i++) {
+            if (node->children[i] != 0) {
+                stack[top++] = node->children[i];
+            }
+        }
+    }
+    return force;
+}
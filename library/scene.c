@@ -1,45 +1,653 @@
 #include <assert.h>
+#include <math.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "scene.h"
+#include "motion.h"
+#include "solver.h"
+#include "spatial.h"
 
 const size_t DEFAULT_CAPACITY = 30;
+const size_t DEFAULT_BATCH_CAPACITY = 8;
+const size_t BATCH_RESIZE_FACTOR = 2;
+//Number of forces or bodies handed to a thread at a time when ticking in parallel.
+const size_t TICK_GRAIN = 256;
+//Every record in a snapshot starts on a multiple of this many bytes.
+const size_t SNAPSHOT_ALIGN = 16;
+const uint64_t ALL_TYPES = UINT64_MAX;
 
-//Stores a force that acts on a list of bodies.
+typedef struct force_batch force_batch_t;
+
+//A handle to one force in a batch. Bodies refer to their forces through these,
+//so the handle stays put while the force's parameters move around in the batch.
 typedef struct force {
-    void *info;
-    force_creator_t force;
-    free_func_t info_freer;
+    force_batch_t *batch;
+    size_t index;
     list_t *force_bodies;
+    bool removed;
 } force_t;
 
+//Stores every force of one kind, with the parameters laid out back to back.
+typedef struct force_batch {
+    const force_kind_t *kind;
+    char *params;
+    force_t **forces;
+    size_t size;
+    size_t capacity;
+    //Number of forces of this kind waiting in the scene's command buffer.
+    size_t pending;
+} force_batch_t;
+
+//A force collected from one chunk of a parallel batch.
+typedef struct {
+    body_t *body;
+    vector_t force;
+    double damping;
+    double stiffness;
+    vector_t reference;
+} buffered_force_t;
+
+typedef struct force_buffer {
+    buffered_force_t *forces;
+    size_t size;
+    size_t capacity;
+    //Bytes the buffer grew by during the current batch.
+    size_t allocated;
+} force_buffer_t;
+
+//A change to the scene that has been put off: either an add asked for
+//during a tick, or a free that has to wait until no snapshot needs the object.
+typedef enum {
+    ADD_BODY,
+    ADD_FORCE,
+    FREE_BODY,
+    FREE_FORCE
+} command_type_t;
+
+typedef struct {
+    command_type_t type;
+    body_t *body;
+    force_t *force;
+    //Where the parameters of an added force start in the command buffer's params.
+    size_t params_offset;
+} scene_command_t;
+
+//Records scene changes made during a tick so they can be applied all at once.
+typedef struct {
+    scene_command_t *commands;
+    size_t size;
+    size_t capacity;
+    char *params;
+    size_t params_size;
+    size_t params_capacity;
+    size_t num_bodies;
+} command_buffer_t;
+
 typedef struct scene {
     list_t *bodies;
-    list_t *forces;
+    list_t *batches;
+    command_buffer_t commands;
+    bool ticking;
+    //Number of snapshots that have not been freed yet.
+    size_t snapshots;
+    //Bodies and forces that left the scene while a snapshot might restore them.
+    command_buffer_t graveyard;
+    //Component pools, one per kind of component used in the scene.
+    list_t *pools;
+    //The bodies of each type other than 0, indexed by type.
+    component_pool_t **type_pools;
+    size_t num_types;
+    //Contact state of the pairs of bodies that are near each other.
+    pair_cache_t *pair_cache;
+    //Static terrain the solver looks up by column.
+    terrain_t *terrain;
+    //IDs of freed bodies, to hand out again before next_id.
+    size_t *free_ids;
+    size_t num_free_ids;
+    size_t free_ids_capacity;
+    size_t next_id;
+    //Bodies with a finite cull margin are removed once they leave this box,
+    //relative to the camera.
+    aabb_t kill_region;
+    vector_t camera;
+    vector_t camera_velocity;
+    job_pool_t *pool;
+    void *context;
+    //State of the scene's random number generator; never 0.
+    uint64_t rng;
+    //One buffer per chunk of the largest parallel batch seen so far.
+    force_buffer_t *buffers;
+    size_t num_buffers;
+    //Number of removed bodies each integration chunk found.
+    size_t *chunk_removed;
+    size_t num_chunk_removed;
+    scene_stats_t stats;
+    //Storage for the per-type and per-kind counts in stats.
+    size_t *type_counts;
+    size_t type_counts_capacity;
+    const force_kind_t **kinds;
+    size_t *kind_counts;
+    size_t kinds_capacity;
+    //Index of the bodies' bounding boxes for queries, built lazily.
+    spatial_index_t *index;
+    //The bodies the index was last built over, kept to reuse the memory.
+    body_t **index_bodies;
+    size_t index_capacity;
+    //Counts the changes to which bodies the scene holds and their types;
+    //the index is rebuilt when index_version falls behind it.
+    size_t version;
+    size_t index_version;
+    //Counts the changes that may have moved bodies; the index is only
+    //refit when index_moved falls behind it.
+    size_t moved;
+    size_t index_moved;
 } scene_t;
 
+void force_buffer_add(force_buffer_t *buffer, body_t *body, vector_t force) {
+    force_buffer_add_implicit(buffer, body, force, 0, 0, VEC_ZERO);
+}
+
+void force_buffer_add_implicit(force_buffer_t *buffer, body_t *body, vector_t force,
+                               double damping, double stiffness, vector_t reference) {
+    if (buffer == NULL) {
+        body_add_implicit_force(body, force, damping, stiffness, reference);
+        return;
+    }
+    if (buffer->size == buffer->capacity) {
+        size_t capacity = buffer->capacity == 0 ? TICK_GRAIN
+                                                : buffer->capacity * BATCH_RESIZE_FACTOR;
+        buffer->allocated += (capacity - buffer->capacity) * sizeof(buffered_force_t);
+        buffer->capacity = capacity;
+        buffer->forces = realloc(buffer->forces,
+                                 sizeof(buffered_force_t) * buffer->capacity);
+        assert(buffer->forces != NULL);
+    }
+    buffer->forces[buffer->size] = (buffered_force_t) {body, force, damping, stiffness,
+                                                            reference};
+    buffer->size++;
+}
+
+//Parameters of a force creator added with scene_add_bodies_force_creator().
+typedef struct {
+    force_creator_t force;
+    void *info;
+    free_func_t info_freer;
+} callback_param_t;
+
+//Calls each force creator in a batch of callback forces.
+void callback_force_creator(scene_t *scene, callback_param_t *params, size_t count,
+                            force_buffer_t *buffer) {
+    for (size_t i = 0; i < count; i++) {
+        params[i].force(params[i].info);
+    }
+}
+
+//Frees the auxiliary value of a callback force.
+void callback_param_free(callback_param_t *param) {
+    if (param->info_freer != NULL) {
+        param->info_freer(param->info);
+    }
+}
+
+const force_kind_t CALLBACK_FORCE = {
+    .name = "callback",
+    .param_size = sizeof(callback_param_t),
+    .creator = (force_batch_creator_t) callback_force_creator,
+    .param_freer = (free_func_t) callback_param_free
+};
+
 void force_free(force_t *force) {
-    if (force->info_freer != NULL){
-        force->info_freer(force->info);
+    if (force->force_bodies != NULL) {
+        list_free(force->force_bodies);
     }
-    free(force->force_bodies);
     free(force);
 }
 
+void *batch_get_params(force_batch_t *batch, size_t index) {
+    return batch->params + index * batch->kind->param_size;
+}
+
+force_batch_t *batch_init(const force_kind_t *kind) {
+    force_batch_t *batch = malloc(sizeof(force_batch_t));
+    assert(batch != NULL);
+    batch->kind = kind;
+    batch->params = malloc(kind->param_size * DEFAULT_BATCH_CAPACITY);
+    batch->forces = malloc(sizeof(force_t *) * DEFAULT_BATCH_CAPACITY);
+    assert(batch->params != NULL && batch->forces != NULL);
+    batch->size = 0;
+    batch->capacity = DEFAULT_BATCH_CAPACITY;
+    batch->pending = 0;
+    return batch;
+}
+
+void batch_free(force_batch_t *batch) {
+    for (size_t i = 0; i < batch->size; i++) {
+        if (batch->kind->param_freer != NULL) {
+            batch->kind->param_freer(batch_get_params(batch, i));
+        }
+        force_free(batch->forces[i]);
+    }
+    free(batch->params);
+    free(batch->forces);
+    free(batch);
+}
+
+//Gives a batch room for at least the given number of forces.
+void batch_reserve(scene_t *scene, force_batch_t *batch, size_t capacity) {
+    if (capacity <= batch->capacity) {
+        return;
+    }
+    //Grow at least geometrically, so a few adds each tick do not copy the batch each tick.
+    if (capacity < batch->capacity * BATCH_RESIZE_FACTOR) {
+        capacity = batch->capacity * BATCH_RESIZE_FACTOR;
+    }
+    scene->stats.bytes_allocated += (capacity - batch->capacity)
+                                    * (batch->kind->param_size + sizeof(force_t *));
+    batch->capacity = capacity;
+    batch->params = realloc(batch->params, batch->kind->param_size * batch->capacity);
+    batch->forces = realloc(batch->forces, sizeof(force_t *) * batch->capacity);
+    assert(batch->params != NULL && batch->forces != NULL);
+}
+
+//Appends a force to the end of a batch, copying its parameters in.
+void batch_add(scene_t *scene, force_batch_t *batch, force_t *force, const void *params) {
+    if (batch->size == batch->capacity) {
+        batch_reserve(scene, batch, batch->capacity * BATCH_RESIZE_FACTOR);
+    }
+    memcpy(batch_get_params(batch, batch->size), params, batch->kind->param_size);
+    batch->forces[batch->size] = force;
+    force->batch = batch;
+    force->index = batch->size;
+    batch->size++;
+}
+
+//Finds the batch that stores forces of a given kind, creating it if needed.
+force_batch_t *scene_get_batch(scene_t *scene, const force_kind_t *kind) {
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        if (batch->kind == kind) {
+            return batch;
+        }
+    }
+    force_batch_t *batch = batch_init(kind);
+    scene->stats.bytes_allocated += sizeof(force_batch_t)
+                                    + DEFAULT_BATCH_CAPACITY
+                                      * (kind->param_size + sizeof(force_t *));
+    list_add(scene->batches, batch);
+    return batch;
+}
+
+//Appends a command to the buffer and returns it.
+scene_command_t *commands_push(scene_t *scene, command_buffer_t *buffer,
+                               command_type_t type) {
+    if (buffer->size == buffer->capacity) {
+        size_t capacity = buffer->capacity == 0 ? DEFAULT_CAPACITY
+                                                : buffer->capacity * BATCH_RESIZE_FACTOR;
+        scene->stats.bytes_allocated += (capacity - buffer->capacity)
+                                        * sizeof(scene_command_t);
+        buffer->capacity = capacity;
+        buffer->commands = realloc(buffer->commands,
+                                   sizeof(scene_command_t) * buffer->capacity);
+        assert(buffer->commands != NULL);
+    }
+    scene_command_t *command = &buffer->commands[buffer->size];
+    buffer->size++;
+    *command = (scene_command_t) {type, NULL, NULL, 0};
+    return command;
+}
+
+//Copies a force's parameters into the buffer and returns where they start.
+size_t commands_push_params(scene_t *scene, command_buffer_t *buffer,
+                            const void *params, size_t size) {
+    if (buffer->params_size + size > buffer->params_capacity) {
+        size_t capacity = buffer->params_capacity == 0 ? size * DEFAULT_CAPACITY
+                                                       : buffer->params_capacity;
+        while (buffer->params_size + size > capacity) {
+            capacity *= BATCH_RESIZE_FACTOR;
+        }
+        scene->stats.bytes_allocated += capacity - buffer->params_capacity;
+        buffer->params_capacity = capacity;
+        buffer->params = realloc(buffer->params, buffer->params_capacity);
+        assert(buffer->params != NULL);
+    }
+    size_t offset = buffer->params_size;
+    memcpy(buffer->params + offset, params, size);
+    buffer->params_size += size;
+    return offset;
+}
+
+//Marks a force as removed and puts it in the graveyard with a copy of its parameters.
+void scene_bury_force(scene_t *scene, force_t *force, const void *params) {
+    force->removed = true;
+    scene_command_t *command = commands_push(scene, &scene->graveyard, FREE_FORCE);
+    command->force = force;
+    command->params_offset = commands_push_params(scene, &scene->graveyard, params,
+                                                  force->batch->kind->param_size);
+}
+
+//Frees the removed forces in a batch and closes the gaps they leave,
+//keeping the surviving forces in the order they were added.
+//While snapshots exist, the removed forces go to the graveyard instead.
+void batch_compact(scene_t *scene, force_batch_t *batch) {
+    size_t param_size = batch->kind->param_size;
+    size_t kept = 0;
+    for (size_t i = 0; i < batch->size; i++) {
+        force_t *force = batch->forces[i];
+        if (force->removed && scene->snapshots > 0) {
+            scene_bury_force(scene, force, batch_get_params(batch, i));
+            continue;
+        }
+        if (force->removed) {
+            if (batch->kind->param_freer != NULL) {
+                batch->kind->param_freer(batch_get_params(batch, i));
+            }
+            force_free(force);
+            continue;
+        }
+        if (kept != i) {
+            memcpy(batch_get_params(batch, kept), batch_get_params(batch, i), param_size);
+            batch->forces[kept] = force;
+            force->index = kept;
+        }
+        kept++;
+    }
+    batch->size = kept;
+}
+
+//Gives a body the lowest free ID.
+void scene_assign_id(scene_t *scene, body_t *body) {
+    if (scene->num_free_ids > 0) {
+        scene->num_free_ids--;
+        body_set_id(body, scene->free_ids[scene->num_free_ids]);
+    } else {
+        body_set_id(body, scene->next_id);
+        scene->next_id++;
+    }
+}
+
+//Frees a body and lets its ID be reused.
+void scene_free_body(scene_t *scene, body_t *body) {
+    if (scene->num_free_ids == scene->free_ids_capacity) {
+        size_t capacity = scene->free_ids_capacity == 0
+                              ? DEFAULT_CAPACITY
+                              : scene->free_ids_capacity * BATCH_RESIZE_FACTOR;
+        scene->stats.bytes_allocated += (capacity - scene->free_ids_capacity)
+                                        * sizeof(size_t);
+        scene->free_ids_capacity = capacity;
+        scene->free_ids = realloc(scene->free_ids, sizeof(size_t) * scene->free_ids_capacity);
+        assert(scene->free_ids != NULL);
+    }
+    scene->free_ids[scene->num_free_ids] = body_get_id(body);
+    scene->num_free_ids++;
+    body_free(body);
+}
+
+int compare_pointers(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t) *(void * const *) a;
+    uintptr_t y = (uintptr_t) *(void * const *) b;
+    return (x > y) - (x < y);
+}
+
+//Orders commands by the body or force they act on.
+int compare_commands(const scene_command_t *a, const scene_command_t *b) {
+    void *x = a->body != NULL ? (void *) a->body : (void *) a->force;
+    void *y = b->body != NULL ? (void *) b->body : (void *) b->force;
+    return compare_pointers(&x, &y);
+}
+
+//Frees everything in the graveyard. If snapshots may have brought some of it
+//back, check_live makes sure those bodies and forces are left alone
+//and that nothing is freed twice.
+void scene_empty_graveyard(scene_t *scene, bool check_live) {
+    command_buffer_t *graveyard = &scene->graveyard;
+    body_t **live = NULL;
+    size_t num_live = list_size(scene->bodies);
+    if (check_live) {
+        qsort(graveyard->commands, graveyard->size, sizeof(scene_command_t),
+              (int (*)(const void *, const void *)) compare_commands);
+        live = malloc(sizeof(body_t *) * (num_live + 1));
+        assert(live != NULL);
+        for (size_t i = 0; i < num_live; i++) {
+            live[i] = list_get(scene->bodies, i);
+        }
+        qsort(live, num_live, sizeof(body_t *), compare_pointers);
+    }
+    for (size_t i = 0; i < graveyard->size; i++) {
+        scene_command_t *command = &graveyard->commands[i];
+        if (check_live && i > 0 && compare_commands(command, command - 1) == 0) {
+            continue;
+        }
+        if (command->type == FREE_BODY) {
+            if (!check_live || bsearch(&command->body, live, num_live, sizeof(body_t *),
+                                       compare_pointers) == NULL) {
+                scene_free_body(scene, command->body);
+            }
+        } else if (command->force->removed) {
+            const force_kind_t *kind = command->force->batch->kind;
+            if (kind->param_freer != NULL) {
+                kind->param_freer(graveyard->params + command->params_offset);
+            }
+            force_free(command->force);
+        }
+    }
+    free(live);
+    graveyard->size = 0;
+    graveyard->params_size = 0;
+}
+
 scene_t *scene_init(void){
     scene_t *scene = malloc(sizeof(scene_t));
     assert(scene != NULL);
-    scene->bodies = list_init(DEFAULT_CAPACITY, body_free);
-    scene->forces = list_init(DEFAULT_CAPACITY, force_free);
+    //The scene frees its bodies itself, since snapshots may need them after removal.
+    scene->bodies = list_init(DEFAULT_CAPACITY, NULL);
+    scene->batches = list_init(0, (free_func_t) batch_free);
+    scene->commands = (command_buffer_t) {NULL, 0, 0, NULL, 0, 0, 0};
+    scene->ticking = false;
+    scene->snapshots = 0;
+    scene->graveyard = (command_buffer_t) {NULL, 0, 0, NULL, 0, 0, 0};
+    scene->pools = list_init(0, (free_func_t) component_pool_free);
+    scene->type_pools = NULL;
+    scene->num_types = 0;
+    scene->pair_cache = pair_cache_init();
+    scene->terrain = terrain_init();
+    scene->free_ids = NULL;
+    scene->num_free_ids = 0;
+    scene->free_ids_capacity = 0;
+    scene->next_id = 0;
+    scene->kill_region = AABB_EVERYWHERE;
+    scene->camera = VEC_ZERO;
+    scene->camera_velocity = VEC_ZERO;
+    scene->pool = NULL;
+    scene->context = NULL;
+    scene_seed(scene, 1);
+    scene->buffers = NULL;
+    scene->num_buffers = 0;
+    scene->chunk_removed = NULL;
+    scene->num_chunk_removed = 0;
+    scene->stats = (scene_stats_t) {0};
+    scene->type_counts = NULL;
+    scene->type_counts_capacity = 0;
+    scene->kinds = NULL;
+    scene->kind_counts = NULL;
+    scene->kinds_capacity = 0;
+    scene->index = spatial_index_init();
+    scene->index_bodies = NULL;
+    scene->index_capacity = 0;
+    scene->version = 1;
+    scene->index_version = 0;
+    scene->moved = 0;
+    scene->index_moved = 0;
     return scene;
 }
 
 void scene_free(scene_t *scene){
+    scene_empty_graveyard(scene, true);
+    for (size_t i = 0; i < list_size(scene->bodies); i++) {
+        body_free(list_get(scene->bodies, i));
+    }
     list_free(scene -> bodies);
-    list_free(scene -> forces);
+    list_free(scene->pools);
+    for (size_t i = 1; i < scene->num_types; i++) {
+        component_pool_free(scene->type_pools[i]);
+    }
+    free(scene->type_pools);
+    pair_cache_free(scene->pair_cache);
+    terrain_free(scene->terrain);
+    free(scene->free_ids);
+    list_free(scene -> batches);
+    free(scene->commands.commands);
+    free(scene->commands.params);
+    free(scene->graveyard.commands);
+    free(scene->graveyard.params);
+    for (size_t i = 0; i < scene->num_buffers; i++) {
+        free(scene->buffers[i].forces);
+    }
+    free(scene->buffers);
+    free(scene->chunk_removed);
+    free(scene->type_counts);
+    free(scene->kinds);
+    free(scene->kind_counts);
+    spatial_index_free(scene->index);
+    free(scene->index_bodies);
     free(scene);
 }
 
+void scene_set_kill_region(scene_t *scene, aabb_t region){
+    scene->kill_region = region;
+}
+
+aabb_t scene_get_kill_region(scene_t *scene){
+    return scene->kill_region;
+}
+
+void scene_set_camera(scene_t *scene, vector_t position){
+    scene->camera = position;
+}
+
+vector_t scene_get_camera(scene_t *scene){
+    return scene->camera;
+}
+
+void scene_set_camera_velocity(scene_t *scene, vector_t velocity){
+    scene->camera_velocity = velocity;
+}
+
+vector_t scene_get_camera_velocity(scene_t *scene){
+    return scene->camera_velocity;
+}
+
+void scene_rebase(scene_t *scene, vector_t origin){
+    assert(!scene->ticking);
+    vector_t shift = vec_negate(origin);
+    for (size_t i = 0; i < list_size(scene->bodies); i++) {
+        body_translate(list_get(scene->bodies, i), shift);
+    }
+    scene->camera = vec_add(scene->camera, shift);
+    terrain_rebase(scene->terrain, origin);
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        if (batch->kind->rebase != NULL) {
+            batch->kind->rebase(batch->params, batch->size, origin);
+        }
+    }
+    scene->moved++;
+}
+
+void scene_set_job_pool(scene_t *scene, job_pool_t *pool){
+    scene->pool = pool;
+}
+
+void scene_set_context(scene_t *scene, void *context){
+    scene->context = context;
+}
+
+void *scene_get_context(scene_t *scene){
+    return scene->context;
+}
+
+void scene_seed(scene_t *scene, unsigned int seed){
+    //Spread the seed over all 64 bits (splitmix64), since xorshift needs a nonzero state.
+    uint64_t state = (uint64_t) seed + 0x9E3779B97F4A7C15ULL;
+    state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    state = (state ^ (state >> 27)) * 0x94D049BB133111EBULL;
+    state ^= state >> 31;
+    scene->rng = state != 0 ? state : 1;
+}
+
+int scene_rand(scene_t *scene){
+    //xorshift64*, keeping the top 31 bits of the result.
+    scene->rng ^= scene->rng >> 12;
+    scene->rng ^= scene->rng << 25;
+    scene->rng ^= scene->rng >> 27;
+    return (int) ((scene->rng * 0x2545F4914F6CDD1DULL) >> 33);
+}
+
+const scene_stats_t *scene_get_stats(scene_t *scene){
+    scene_stats_t *stats = &scene->stats;
+    stats->bodies = list_size(scene->bodies);
+    //Type 0 has no index; its bodies are the ones left over.
+    size_t num_types = scene->num_types > 0 ? scene->num_types : 1;
+    if (num_types > scene->type_counts_capacity) {
+        scene->type_counts = realloc(scene->type_counts, sizeof(size_t) * num_types);
+        assert(scene->type_counts != NULL);
+        scene->type_counts_capacity = num_types;
+    }
+    scene->type_counts[0] = stats->bodies;
+    for (size_t i = 1; i < num_types; i++) {
+        scene->type_counts[i] = component_pool_size(scene->type_pools[i]);
+        scene->type_counts[0] -= scene->type_counts[i];
+    }
+    stats->num_types = num_types;
+    stats->bodies_by_type = scene->type_counts;
+
+    size_t num_kinds = list_size(scene->batches);
+    if (num_kinds > scene->kinds_capacity) {
+        scene->kinds = realloc(scene->kinds, sizeof(force_kind_t *) * num_kinds);
+        scene->kind_counts = realloc(scene->kind_counts, sizeof(size_t) * num_kinds);
+        assert(scene->kinds != NULL && scene->kind_counts != NULL);
+        scene->kinds_capacity = num_kinds;
+    }
+    stats->forces = 0;
+    for (size_t i = 0; i < num_kinds; i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        scene->kinds[i] = batch->kind;
+        scene->kind_counts[i] = batch->size;
+        stats->forces += batch->size;
+    }
+    stats->num_kinds = num_kinds;
+    stats->kinds = scene->kinds;
+    stats->forces_by_kind = scene->kind_counts;
+    stats->cached_pairs = pair_cache_size(scene->pair_cache);
+    return stats;
+}
+
+void scene_count_narrowphase(scene_t *scene, size_t tests, size_t axes,
+                             size_t hint_hits, size_t collisions){
+    scene->stats.narrowphase_tests += tests;
+    scene->stats.sat_axes += axes;
+    scene->stats.sat_hint_hits += hint_hits;
+    scene->stats.collisions += collisions;
+}
+
+pair_cache_t *scene_get_pair_cache(scene_t *scene){
+    return scene->pair_cache;
+}
+
+terrain_t *scene_get_terrain(scene_t *scene){
+    return scene->terrain;
+}
+
+void scene_update_terrain(scene_t *scene, const terrain_span_t *span, aabb_t box){
+    assert(!scene->ticking);
+    body_resize_rect(span->body, box);
+    terrain_update(scene->terrain, span);
+    //The body's box changed without a tick, so the index has to be refit.
+    scene->moved++;
+}
+
 size_t scene_bodies(scene_t *scene){
     return list_size(scene->bodies);
 }
@@ -48,17 +656,119 @@ body_t *scene_get_body(scene_t *scene, size_t index){
     return list_get(scene->bodies, index);
 }
 
-void scene_add_body(scene_t *scene, body_t *body){
+//Adds a body to the scene's list of bodies, counting any growth of the list.
+void scene_list_body(scene_t *scene, body_t *body){
+    size_t capacity = list_capacity(scene->bodies);
     list_add(scene->bodies, body);
+    scene->stats.bytes_allocated += (list_capacity(scene->bodies) - capacity)
+                                    * sizeof(body_t *);
+    scene->version++;
+}
+
+void scene_add_body(scene_t *scene, body_t *body){
+    scene_assign_id(scene, body);
+    if (scene->ticking) {
+        commands_push(scene, &scene->commands, ADD_BODY)->body = body;
+        scene->commands.num_bodies++;
+        return;
+    }
+    scene_list_body(scene, body);
 }
 
 void scene_remove_body(scene_t *scene, size_t index){
     body_remove(list_get(scene->bodies, index));
 }
 
-void scene_remove_force(scene_t *scene, size_t index){
-    force_t *removed = list_remove(scene->forces, index);
-    force_free(removed);
+component_pool_t *scene_get_components(scene_t *scene, const component_kind_t *kind){
+    for (size_t i = 0; i < list_size(scene->pools); i++) {
+        component_pool_t *pool = list_get(scene->pools, i);
+        if (component_pool_kind(pool) == kind) {
+            return pool;
+        }
+    }
+    component_pool_t *pool = component_pool_init(kind);
+    list_add(scene->pools, pool);
+    return pool;
+}
+
+//Membership of a type; the pools of this kind hold no data.
+const component_kind_t TYPE_MEMBER = {
+    .name = "type member",
+    .size = 0
+};
+
+component_pool_t *scene_get_bodies_of_type(scene_t *scene, size_t type){
+    assert(type > 0);
+    if (type >= scene->num_types) {
+        scene->type_pools = realloc(scene->type_pools,
+                                    sizeof(component_pool_t *) * (type + 1));
+        assert(scene->type_pools != NULL);
+        for (size_t i = scene->num_types; i <= type; i++) {
+            scene->type_pools[i] = i == 0 ? NULL : component_pool_init(&TYPE_MEMBER);
+        }
+        scene->num_types = type + 1;
+    }
+    return scene->type_pools[type];
+}
+
+//Brings the spatial index up to date: rebuilds it if bodies were added,
+//removed or retyped since it was built, or refits it if they only moved.
+spatial_index_t *scene_get_index(scene_t *scene) {
+    if (scene->index_version == scene->version) {
+        if (scene->index_moved != scene->moved) {
+            spatial_index_refit(scene->index, scene->index_bodies,
+                                list_size(scene->bodies));
+            scene->index_moved = scene->moved;
+        }
+        return scene->index;
+    }
+    size_t count = list_size(scene->bodies);
+    if (count > scene->index_capacity) {
+        scene->index_capacity = count;
+        scene->index_bodies = realloc(scene->index_bodies,
+                                      sizeof(body_t *) * scene->index_capacity);
+        assert(scene->index_bodies != NULL);
+    }
+    for (size_t i = 0; i < count; i++) {
+        scene->index_bodies[i] = list_get(scene->bodies, i);
+    }
+    spatial_index_build(scene->index, scene->index_bodies, count);
+    scene->index_version = scene->version;
+    scene->index_moved = scene->moved;
+    return scene->index;
+}
+
+size_t scene_query_aabb(scene_t *scene, aabb_t box, uint64_t types, body_t **out,
+                        size_t capacity) {
+    return spatial_index_query_aabb(scene_get_index(scene), box, types, out, capacity);
+}
+
+size_t scene_query_point(scene_t *scene, vector_t point, uint64_t types, body_t **out,
+                         size_t capacity) {
+    return spatial_index_query_point(scene_get_index(scene), point, types, out, capacity);
+}
+
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end, uint64_t types,
+                   ray_hit_t *hit) {
+    return spatial_index_raycast(scene_get_index(scene), start, end, types, hit);
+}
+
+void scene_set_type(scene_t *scene, body_t *body, size_t type){
+    //A body keeps its first type; retyping would leave it in the old index.
+    assert(body_get_type(body) == 0);
+    body_set_type(body, type);
+    if (type > 0) {
+        component_pool_add(scene_get_bodies_of_type(scene, type), body);
+    }
+    scene->version++;
+}
+
+void *scene_add_component(scene_t *scene, body_t *body, const component_kind_t *kind){
+    return component_pool_add(scene_get_components(scene, kind), body);
+}
+
+void *scene_get_component(scene_t *scene, body_t *body, const component_kind_t *kind){
+    return component_pool_get(scene_get_components(scene, kind), body);
 }
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux, 
@@ -68,38 +778,543 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
 
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
                                         list_t *bodies, free_func_t freer) {
-    force_t *new_force = malloc(sizeof(force_t));
-    *new_force = (force_t){aux, forcer, freer, bodies};
-    list_add(scene->forces, new_force);
+    callback_param_t params = {forcer, aux, freer};
+    scene_add_batched_force(scene, &CALLBACK_FORCE, &params, bodies);
+}
+
+void scene_add_batched_force(scene_t *scene, const force_kind_t *kind,
+                             const void *params, list_t *bodies) {
+    force_t *force = malloc(sizeof(force_t));
+    assert(force != NULL);
+    *force = (force_t){NULL, 0, bodies, false};
+    scene->stats.bytes_allocated += sizeof(force_t);
+    if (scene->ticking) {
+        //The batches are being evaluated, so hold on to the force until they are done.
+        force->batch = scene_get_batch(scene, kind);
+        force->batch->pending++;
+        scene_command_t *command = commands_push(scene, &scene->commands, ADD_FORCE);
+        command->force = force;
+        command->params_offset = commands_push_params(scene, &scene->commands, params,
+                                                      kind->param_size);
+    } else {
+        batch_add(scene, scene_get_batch(scene, kind), force, params);
+    }
+    if (bodies != NULL) {
+        for (size_t i = 0; i < list_size(bodies); i++) {
+            list_add(body_get_forces(list_get(bodies, i)), force);
+        }
+    }
+}
+
+//Applies the adds recorded during a tick, in the order they were made.
+//Returns how many of the added bodies were already marked for removal.
+size_t scene_apply_commands(scene_t *scene) {
+    command_buffer_t *buffer = &scene->commands;
+    if (buffer->size == 0) {
+        return 0;
+    }
+    //Grow each list at most once, however many adds are waiting for it.
+    size_t capacity = list_capacity(scene->bodies);
+    list_reserve(scene->bodies, buffer->num_bodies);
+    scene->stats.bytes_allocated += (list_capacity(scene->bodies) - capacity)
+                                    * sizeof(body_t *);
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        batch_reserve(scene, batch, batch->size + batch->pending);
+        batch->pending = 0;
+    }
+    size_t removed = 0;
+    for (size_t i = 0; i < buffer->size; i++) {
+        scene_command_t *command = &buffer->commands[i];
+        if (command->type == ADD_BODY) {
+            list_add(scene->bodies, command->body);
+            if (body_is_removed(command->body)) {
+                removed++;
+            }
+        } else {
+            batch_add(scene, command->force->batch, command->force,
+                      buffer->params + command->params_offset);
+        }
+    }
+    buffer->size = 0;
+    buffer->params_size = 0;
+    buffer->num_bodies = 0;
+    return removed;
+}
+
+//Takes a force out of a body's list of forces.
+void unlink_force(body_t *body, force_t *force) {
+    list_t *forces = body_get_forces(body);
+    for (size_t i = 0; i < list_size(forces); i++) {
+        if (list_get(forces, i) == force) {
+            list_remove(forces, i);
+            return;
+        }
+    }
+}
+
+//Marks every force acting on a removed body as removed,
+//and unlinks those forces from the surviving bodies they act on.
+void retire_forces(body_t *body) {
+    list_t *forces = body_get_forces(body);
+    for (size_t i = 0; i < list_size(forces); i++) {
+        force_t *force = list_get(forces, i);
+        if (force->removed) {
+            continue;
+        }
+        force->removed = true;
+        for (size_t j = 0; j < list_size(force->force_bodies); j++) {
+            body_t *other = list_get(force->force_bodies, j);
+            if (!body_is_removed(other)) {
+                unlink_force(other, force);
+            }
+        }
+    }
+}
+
+bool body_is_live(body_t *body) {
+    return !body_is_removed(body);
+}
+
+//Makes sure the scene has at least one force buffer per chunk, all empty.
+void scene_reset_buffers(scene_t *scene, size_t chunks) {
+    if (chunks > scene->num_buffers) {
+        scene->stats.bytes_allocated += (chunks - scene->num_buffers) * sizeof(force_buffer_t);
+        scene->buffers = realloc(scene->buffers, sizeof(force_buffer_t) * chunks);
+        assert(scene->buffers != NULL);
+        for (size_t i = scene->num_buffers; i < chunks; i++) {
+            scene->buffers[i] = (force_buffer_t) {NULL, 0, 0, 0};
+        }
+        scene->num_buffers = chunks;
+    }
+    for (size_t i = 0; i < chunks; i++) {
+        scene->buffers[i].size = 0;
+    }
+}
+
+//What a chunk of a batch needs to know to run.
+typedef struct {
+    scene_t *scene;
+    force_batch_t *batch;
+    force_batch_creator_t func;
+    bool buffered;
+} batch_job_t;
+
+void run_batch_chunk(batch_job_t *job, size_t start, size_t end, size_t chunk) {
+    force_buffer_t *buffer = job->buffered ? &job->scene->buffers[chunk] : NULL;
+    job->func(job->scene, batch_get_params(job->batch, start), end - start, buffer);
+}
+
+//Evaluates one batch, splitting the work across the job pool where the kind allows.
+void scene_evaluate_batch(scene_t *scene, force_batch_t *batch) {
+    const force_kind_t *kind = batch->kind;
+    size_t chunks = job_pool_chunks(batch->size, TICK_GRAIN);
+    bool split = job_pool_threads(scene->pool) > 1 && chunks > 1;
+    if (kind->prepare != NULL) {
+        batch_job_t job = {scene, batch, kind->prepare, false};
+        job_pool_parallel_for(split ? scene->pool : NULL, batch->size, TICK_GRAIN,
+                              (job_func_t) run_batch_chunk, &job);
+    }
+    if (!split || !kind->parallel) {
+        kind->creator(scene, batch->params, batch->size, NULL);
+        return;
+    }
+    scene_reset_buffers(scene, chunks);
+    batch_job_t job = {scene, batch, kind->creator, true};
+    job_pool_parallel_for(scene->pool, batch->size, TICK_GRAIN,
+                          (job_func_t) run_batch_chunk, &job);
+    //Apply the forces in chunk order, which is the order a single thread would use.
+    for (size_t i = 0; i < chunks; i++) {
+        force_buffer_t *buffer = &scene->buffers[i];
+        for (size_t j = 0; j < buffer->size; j++) {
+            buffered_force_t *added = &buffer->forces[j];
+            body_add_implicit_force(added->body, added->force, added->damping,
+                                    added->stiffness, added->reference);
+        }
+        scene->stats.bytes_allocated += buffer->allocated;
+        buffer->allocated = 0;
+    }
+}
+
+//What a chunk of body integration needs to know to run.
+typedef struct {
+    scene_t *scene;
+    double dt;
+    //The kill region in scene coordinates, where the camera is after the tick.
+    aabb_t region;
+} tick_job_t;
+
+void run_tick_chunk(tick_job_t *job, size_t start, size_t end, size_t chunk) {
+    size_t removed = 0;
+    for (size_t i = start; i < end; i++) {
+        body_t *body = list_get(job->scene->bodies, i);
+        body_tick(body, job->dt);
+        double margin = body_get_cull_margin(body);
+        if (margin < INFINITY &&
+                !aabb_overlaps(aabb_expand(job->region, margin),
+                               body_get_aabb(body))) {
+            body_remove(body);
+        }
+        if (body_is_removed(body)) {
+            removed++;
+        }
+    }
+    job->scene->chunk_removed[chunk] = removed;
+}
+
+//Ticks every body and returns how many of them are marked for removal.
+size_t scene_integrate(scene_t *scene, double dt) {
+    size_t chunks = job_pool_chunks(list_size(scene->bodies), TICK_GRAIN);
+    if (chunks > scene->num_chunk_removed) {
+        scene->chunk_removed = realloc(scene->chunk_removed, sizeof(size_t) * chunks);
+        assert(scene->chunk_removed != NULL);
+        scene->num_chunk_removed = chunks;
+    }
+    aabb_t region = scene->kill_region;
+    region.min = vec_add(region.min, scene->camera);
+    region.max = vec_add(region.max, scene->camera);
+    tick_job_t job = {scene, dt, region};
+    job_pool_parallel_for(scene->pool, list_size(scene->bodies), TICK_GRAIN,
+                          (job_func_t) run_tick_chunk, &job);
+    size_t removed = 0;
+    for (size_t i = 0; i < chunks; i++) {
+        removed += scene->chunk_removed[i];
+    }
+    return removed;
 }
 
 void scene_tick(scene_t *scene, double dt){
-    for (size_t i = 0; i < list_size(scene->forces); i++) {
-        force_t *curr =  list_get(scene->forces, i);
-        curr->force(curr->info);
+    scene->stats.narrowphase_tests = 0;
+    scene->stats.sat_axes = 0;
+    scene->stats.sat_hint_hits = 0;
+    scene->stats.collisions = 0;
+    scene->stats.bodies_removed = 0;
+    scene->stats.bytes_allocated = 0;
+    size_t cache_bytes = pair_cache_bytes(scene->pair_cache);
+    scene->ticking = true;
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        if (batch->size > 0) {
+            scene_evaluate_batch(scene, batch);
+        }
+    }
+    motion_step(scene, dt);
+    solver_step(scene, dt);
+    scene->stats.bytes_allocated += pair_cache_bytes(scene->pair_cache) - cache_bytes;
+    scene->camera = vec_add(scene->camera, vec_multiply(dt, scene->camera_velocity));
+    size_t removed = scene_integrate(scene, dt);
+    scene->ticking = false;
+    scene->moved++;
+    //Sync point: everything added during the tick joins the scene here.
+    removed += scene_apply_commands(scene);
+    //Nothing died this tick, so there is nothing to clean up.
+    if (removed == 0) {
+        return;
     }
+    scene->stats.bodies_removed = removed;
+    scene->version++;
     for (size_t i = 0; i < list_size(scene->bodies); i++) {
-        body_tick(list_get(scene->bodies, i), dt);
-    }
-    for (int i = ((int) list_size(scene->forces))-1; i >= 0; i--) {
-        force_t *cur = list_get(scene->forces, i);
-        bool removed = false;
-        if (cur->force_bodies != NULL) {
-            for (int j = 0; j < list_size(cur->force_bodies); j++) {
-                if (body_is_removed(list_get(cur->force_bodies,j))) {
-                    removed = true;
-                    break;
-                }
+        body_t *body = list_get(scene->bodies, i);
+        if (body_is_removed(body)) {
+            retire_forces(body);
+            commands_push(scene, &scene->graveyard, FREE_BODY)->body = body;
+        }
+    }
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        batch_compact(scene, list_get(scene->batches, i));
+    }
+    list_filter(scene->bodies, (keep_func_t) body_is_live);
+    for (size_t i = 0; i < list_size(scene->pools); i++) {
+        component_pool_filter(list_get(scene->pools, i), (keep_func_t) body_is_live);
+    }
+    for (size_t i = 1; i < scene->num_types; i++) {
+        component_pool_filter(scene->type_pools[i], (keep_func_t) body_is_live);
+    }
+    pair_cache_filter(scene->pair_cache, (keep_func_t) body_is_live);
+    terrain_filter(scene->terrain, (keep_func_t) body_is_live);
+    if (scene->snapshots == 0) {
+        scene_empty_graveyard(scene, false);
+    }
+}
+
+//A snapshot is one allocation: this header, the sorted addresses of the bodies
+//and forces it holds, the pair cache, and then one record per body,
+//per non-empty batch and per component pool.
+typedef struct scene_snapshot {
+    scene_t *scene;
+    size_t size;
+    uint64_t rng;
+    vector_t camera;
+    vector_t camera_velocity;
+    body_t **bodies;
+    size_t num_bodies;
+    force_t **forces;
+    size_t num_forces;
+    size_t num_batches;
+    size_t num_pools;
+    contact_t *pairs;
+    size_t num_pairs;
+    terrain_span_t *spans;
+    size_t num_spans;
+    vector_t terrain_origin;
+    char *records;
+} scene_snapshot_t;
+
+//Starts a body record, followed by the body's state and then its info.
+typedef struct {
+    body_t *body;
+    size_t state_size;
+    size_t info_size;
+} body_record_t;
+
+//Starts a batch record, followed by the force handles and then their parameters.
+typedef struct {
+    const force_kind_t *kind;
+    size_t count;
+} batch_record_t;
+
+//Starts a component pool record, followed by the bodies and then their components.
+typedef struct {
+    const component_kind_t *kind;
+    size_t count;
+} pool_record_t;
+
+size_t snapshot_align(size_t size) {
+    return (size + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+size_t snapshot_info_size(body_t *body, info_size_func_t info_size) {
+    if (info_size == NULL || body_get_info(body) == NULL) {
+        return 0;
+    }
+    return info_size(body_get_info(body));
+}
+
+scene_snapshot_t *scene_snapshot(scene_t *scene, info_size_func_t info_size) {
+    assert(!scene->ticking);
+    size_t num_bodies = list_size(scene->bodies);
+    size_t num_forces = 0;
+    size_t num_batches = 0;
+    size_t size = snapshot_align(sizeof(scene_snapshot_t))
+                  + snapshot_align(sizeof(body_t *) * num_bodies);
+    for (size_t i = 0; i < num_bodies; i++) {
+        body_t *body = list_get(scene->bodies, i);
+        size += snapshot_align(sizeof(body_record_t))
+                + snapshot_align(body_state_size(body))
+                + snapshot_align(snapshot_info_size(body, info_size));
+    }
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        if (batch->size == 0) {
+            continue;
+        }
+        num_forces += batch->size;
+        num_batches++;
+        size += snapshot_align(sizeof(batch_record_t))
+                + snapshot_align(sizeof(force_t *) * batch->size)
+                + snapshot_align(batch->kind->param_size * batch->size);
+    }
+    size += snapshot_align(sizeof(force_t *) * num_forces);
+    size_t num_pairs = pair_cache_size(scene->pair_cache);
+    size += snapshot_align(sizeof(contact_t) * num_pairs);
+    size_t num_spans = terrain_size(scene->terrain);
+    size += snapshot_align(sizeof(terrain_span_t) * num_spans);
+    size_t num_pools = list_size(scene->pools);
+    for (size_t i = 0; i < num_pools; i++) {
+        component_pool_t *pool = list_get(scene->pools, i);
+        size_t count = component_pool_size(pool);
+        size += snapshot_align(sizeof(pool_record_t))
+                + snapshot_align(sizeof(body_t *) * count)
+                + snapshot_align(component_pool_kind(pool)->size * count);
+    }
+
+    char *buffer = malloc(size);
+    assert(buffer != NULL);
+    scene_snapshot_t *snapshot = (scene_snapshot_t *) buffer;
+    char *next = buffer + snapshot_align(sizeof(scene_snapshot_t));
+    snapshot->scene = scene;
+    snapshot->size = size;
+    snapshot->rng = scene->rng;
+    snapshot->camera = scene->camera;
+    snapshot->camera_velocity = scene->camera_velocity;
+    snapshot->bodies = (body_t **) next;
+    snapshot->num_bodies = num_bodies;
+    next += snapshot_align(sizeof(body_t *) * num_bodies);
+    snapshot->forces = (force_t **) next;
+    snapshot->num_forces = num_forces;
+    next += snapshot_align(sizeof(force_t *) * num_forces);
+    snapshot->pairs = (contact_t *) next;
+    snapshot->num_pairs = num_pairs;
+    if (num_pairs > 0) {
+        memcpy(snapshot->pairs, pair_cache_contacts(scene->pair_cache),
+               sizeof(contact_t) * num_pairs);
+    }
+    next += snapshot_align(sizeof(contact_t) * num_pairs);
+    snapshot->spans = (terrain_span_t *) next;
+    snapshot->num_spans = num_spans;
+    snapshot->terrain_origin = terrain_get_origin(scene->terrain);
+    if (num_spans > 0) {
+        memcpy(snapshot->spans, terrain_spans(scene->terrain),
+               sizeof(terrain_span_t) * num_spans);
+    }
+    next += snapshot_align(sizeof(terrain_span_t) * num_spans);
+    snapshot->num_batches = num_batches;
+    snapshot->num_pools = num_pools;
+    snapshot->records = next;
+
+    for (size_t i = 0; i < num_bodies; i++) {
+        body_t *body = list_get(scene->bodies, i);
+        body_record_t *record = (body_record_t *) next;
+        *record = (body_record_t) {body, body_state_size(body),
+                                   snapshot_info_size(body, info_size)};
+        next += snapshot_align(sizeof(body_record_t));
+        body_save_state(body, next);
+        next += snapshot_align(record->state_size);
+        if (record->info_size > 0) {
+            memcpy(next, body_get_info(body), record->info_size);
+        }
+        next += snapshot_align(record->info_size);
+        snapshot->bodies[i] = body;
+    }
+    size_t num_saved = 0;
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        if (batch->size == 0) {
+            continue;
+        }
+        *(batch_record_t *) next = (batch_record_t) {batch->kind, batch->size};
+        next += snapshot_align(sizeof(batch_record_t));
+        memcpy(next, batch->forces, sizeof(force_t *) * batch->size);
+        memcpy(snapshot->forces + num_saved, batch->forces, sizeof(force_t *) * batch->size);
+        num_saved += batch->size;
+        next += snapshot_align(sizeof(force_t *) * batch->size);
+        memcpy(next, batch->params, batch->kind->param_size * batch->size);
+        next += snapshot_align(batch->kind->param_size * batch->size);
+    }
+    for (size_t i = 0; i < num_pools; i++) {
+        component_pool_t *pool = list_get(scene->pools, i);
+        pool_record_t *record = (pool_record_t *) next;
+        *record = (pool_record_t) {component_pool_kind(pool), component_pool_size(pool)};
+        next += snapshot_align(sizeof(pool_record_t));
+        memcpy(next, component_pool_bodies(pool), sizeof(body_t *) * record->count);
+        next += snapshot_align(sizeof(body_t *) * record->count);
+        memcpy(next, component_pool_data(pool), record->kind->size * record->count);
+        next += snapshot_align(record->kind->size * record->count);
+    }
+    qsort(snapshot->bodies, num_bodies, sizeof(body_t *), compare_pointers);
+    qsort(snapshot->forces, num_forces, sizeof(force_t *), compare_pointers);
+    scene->snapshots++;
+    return snapshot;
+}
+
+bool keep_none(void *value) {
+    return false;
+}
+
+void scene_restore(scene_t *scene, scene_snapshot_t *snapshot) {
+    assert(!scene->ticking && snapshot->scene == scene);
+    scene->version++;
+    scene->rng = snapshot->rng;
+    scene->camera = snapshot->camera;
+    scene->camera_velocity = snapshot->camera_velocity;
+    //Whatever the snapshot does not hold leaves the scene,
+    //but is kept around in case another snapshot holds it.
+    for (size_t i = 0; i < list_size(scene->bodies); i++) {
+        body_t *body = list_get(scene->bodies, i);
+        if (bsearch(&body, snapshot->bodies, snapshot->num_bodies, sizeof(body_t *),
+                    compare_pointers) == NULL) {
+            commands_push(scene, &scene->graveyard, FREE_BODY)->body = body;
+        }
+    }
+    for (size_t i = 0; i < list_size(scene->batches); i++) {
+        force_batch_t *batch = list_get(scene->batches, i);
+        for (size_t j = 0; j < batch->size; j++) {
+            force_t *force = batch->forces[j];
+            if (bsearch(&force, snapshot->forces, snapshot->num_forces, sizeof(force_t *),
+                        compare_pointers) == NULL) {
+                scene_bury_force(scene, force, batch_get_params(batch, j));
             }
         }
-        if (removed) {
-            scene_remove_force(scene, i);
+        batch->size = 0;
+    }
+
+    list_filter(scene->bodies, keep_none);
+    list_reserve(scene->bodies, snapshot->num_bodies);
+    char *next = snapshot->records;
+    for (size_t i = 0; i < snapshot->num_bodies; i++) {
+        body_record_t *record = (body_record_t *) next;
+        next += snapshot_align(sizeof(body_record_t));
+        body_load_state(record->body, next);
+        next += snapshot_align(record->state_size);
+        if (record->info_size > 0) {
+            memcpy(body_get_info(record->body), next, record->info_size);
+        }
+        next += snapshot_align(record->info_size);
+        //The reverse index is rebuilt from the restored forces below.
+        list_filter(body_get_forces(record->body), keep_none);
+        list_add(scene->bodies, record->body);
+    }
+    for (size_t i = 0; i < snapshot->num_batches; i++) {
+        batch_record_t *record = (batch_record_t *) next;
+        next += snapshot_align(sizeof(batch_record_t));
+        force_t **forces = (force_t **) next;
+        next += snapshot_align(sizeof(force_t *) * record->count);
+        force_batch_t *batch = scene_get_batch(scene, record->kind);
+        batch_reserve(scene, batch, record->count);
+        memcpy(batch->params, next, record->kind->param_size * record->count);
+        next += snapshot_align(record->kind->param_size * record->count);
+        for (size_t j = 0; j < record->count; j++) {
+            force_t *force = forces[j];
+            batch->forces[j] = force;
+            force->batch = batch;
+            force->index = j;
+            force->removed = false;
+            if (force->force_bodies == NULL) {
+                continue;
+            }
+            for (size_t k = 0; k < list_size(force->force_bodies); k++) {
+                list_add(body_get_forces(list_get(force->force_bodies, k)), force);
+            }
         }
+        batch->size = record->count;
+    }
+    //Pools the snapshot does not mention were empty when it was taken.
+    for (size_t i = 0; i < list_size(scene->pools); i++) {
+        component_pool_set(list_get(scene->pools, i), NULL, NULL, 0);
     }
-    for (int i = ((int) list_size(scene->bodies))-1; i >= 0; i--) {
-        if (body_is_removed(list_get(scene->bodies, i))) {
-            body_t *removed = list_remove(scene->bodies, i);
-            body_free(removed);
+    for (size_t i = 0; i < snapshot->num_pools; i++) {
+        pool_record_t *record = (pool_record_t *) next;
+        next += snapshot_align(sizeof(pool_record_t));
+        body_t **bodies = (body_t **) next;
+        next += snapshot_align(sizeof(body_t *) * record->count);
+        component_pool_set(scene_get_components(scene, record->kind), bodies, next,
+                           record->count);
+        next += snapshot_align(record->kind->size * record->count);
+    }
+    pair_cache_set(scene->pair_cache, snapshot->pairs, snapshot->num_pairs);
+    terrain_set(scene->terrain, snapshot->spans, snapshot->num_spans,
+                snapshot->terrain_origin);
+    //Rebuild the type indices in body order, which is the order they were built in.
+    for (size_t i = 1; i < scene->num_types; i++) {
+        component_pool_set(scene->type_pools[i], NULL, NULL, 0);
+    }
+    for (size_t i = 0; i < list_size(scene->bodies); i++) {
+        body_t *body = list_get(scene->bodies, i);
+        if (body_get_type(body) > 0) {
+            component_pool_add(scene_get_bodies_of_type(scene, body_get_type(body)), body);
         }
     }
 }
+
+size_t scene_snapshot_size(scene_snapshot_t *snapshot) {
+    return snapshot->size;
+}
+
+void scene_snapshot_free(scene_snapshot_t *snapshot) {
+    scene_t *scene = snapshot->scene;
+    free(snapshot);
+    scene->snapshots--;
+    if (scene->snapshots == 0) {
+        scene_empty_graveyard(scene, true);
+    }
+}
@@ -11,42 +11,47 @@ const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
 const rgb_color_t BACKGROUND = {255, 255, 255};
 
-/**
- * The coordinate at the center of the screen.
- */
-vector_t center;
-/**
- * The coordinate difference from the center to the top right corner.
- */
-vector_t max_diff;
-/**
- * The SDL window where the scene is rendered.
- */
-SDL_Window *window;
-/**
- * The renderer used to draw the scene.
- */
-SDL_Renderer *renderer;
-
-/**
- * The keypress handler, or NULL if none has been configured.
- */
-event_handler_t key_handler = NULL;
-/**
- * The mousepress handler, or NULL if none has been configured.
- */
-event_handler_t mouse_handler = NULL;
-
-/**
- * SDL's timestamp when a key was last pressed or released.
- * Used to mesasure how long a key has been held.
- */
-uint32_t key_start_timestamp;
-/**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
- */
-clock_t last_clock = 0;
+typedef struct sdl_context {
+    /**
+     * The coordinate at the center of the screen.
+     */
+    vector_t center;
+    /**
+     * The coordinate difference from the center to the top right corner.
+     */
+    vector_t max_diff;
+    /**
+     * The camera of the scene being drawn (see scene_set_camera()).
+     * Bodies are drawn offset by it; text and the boundary are not.
+     */
+    vector_t camera;
+    /**
+     * The SDL window where the scene is rendered, or NULL if headless.
+     */
+    SDL_Window *window;
+    /**
+     * The renderer used to draw the scene, or NULL if headless.
+     */
+    SDL_Renderer *renderer;
+    /**
+     * The keypress handler, or NULL if none has been configured.
+     */
+    event_handler_t key_handler;
+    /**
+     * The mousepress handler, or NULL if none has been configured.
+     */
+    event_handler_t mouse_handler;
+    /**
+     * SDL's timestamp when a key was last pressed or released.
+     * Used to mesasure how long a key has been held.
+     */
+    uint32_t key_start_timestamp;
+    /**
+     * The value of clock() when time_since_last_tick() was last called.
+     * Initially 0.
+     */
+    clock_t last_clock;
+} sdl_context_t;
 
 typedef struct sprite{
     SDL_Texture *texture;
@@ -91,12 +96,12 @@ Mix_Chunk *loadEffects(const char *effect_name){
 }
 
 /** Computes the center of the window in pixel coordinates */
-vector_t get_window_center(void) {
+vector_t get_window_center(sdl_context_t *context) {
     int *width = malloc(sizeof(*width)),
         *height = malloc(sizeof(*height));
     assert(width != NULL);
     assert(height != NULL);
-    SDL_GetWindowSize(window, width, height);
+    SDL_GetWindowSize(context->window, width, height);
     vector_t dimensions = {.x = *width, .y = *height};
     free(width);
     free(height);
@@ -108,19 +113,20 @@ vector_t get_window_center(void) {
  * The scene is scaled by the same factor in the x and y dimensions,
  * chosen to maximize the size of the scene while keeping it in the window.
  */
-double get_scene_scale(vector_t window_center) {
+double get_scene_scale(sdl_context_t *context, vector_t window_center) {
     // Scale scene so it fits entirely in the window
-    double x_scale = window_center.x / max_diff.x,
-           y_scale = window_center.y / max_diff.y;
+    double x_scale = window_center.x / context->max_diff.x,
+           y_scale = window_center.y / context->max_diff.y;
     return x_scale < y_scale ? x_scale : y_scale;
 }
 
 /** Maps a scene coordinate to a window coordinate */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
+vector_t get_window_position(sdl_context_t *context, vector_t scene_pos,
+                             vector_t window_center) {
     // Scale scene coordinates by the scaling factor
     // and map the center of the scene to the center of the window
-    vector_t scene_center_offset = vec_subtract(scene_pos, center);
-    double scale = get_scene_scale(window_center);
+    vector_t scene_center_offset = vec_subtract(scene_pos, context->center);
+    double scale = get_scene_scale(context, window_center);
     vector_t pixel_center_offset = vec_multiply(scale, scene_center_offset);
     vector_t pixel = {
         .x = round(window_center.x + pixel_center_offset.x),
@@ -130,6 +136,13 @@ vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
     return pixel;
 }
 
+/** Maps the position of a body in the scene to a window coordinate */
+vector_t get_body_window_position(sdl_context_t *context, vector_t scene_pos,
+                                  vector_t window_center) {
+    return get_window_position(context, vec_subtract(scene_pos, context->camera),
+                               window_center);
+}
+
 /**
  * Converts an SDL key code to a char.
  * 7-bit ASCII characters are just returned
@@ -160,12 +173,20 @@ char get_mousecode(SDL_MouseButtonEvent mouse) {
     }
 }
 
-sprite_t *sprite_image(const char *image, double scale, SDL_Rect *in){
+sprite_t *sprite_image(sdl_context_t *context, const char *image, double scale,
+                       SDL_Rect *in){
     sprite_t *sprite = malloc(sizeof(sprite_t));
-    sprite->texture = IMG_LoadTexture(renderer, image);
     int *w = malloc(sizeof(int));
     int *h = malloc(sizeof(int));
-    SDL_QueryTexture(sprite->texture, NULL, NULL, w, h);
+    if (context->renderer != NULL) {
+        sprite->texture = IMG_LoadTexture(context->renderer, image);
+        SDL_QueryTexture(sprite->texture, NULL, NULL, w, h);
+    } else {
+        //Headless sprites have no texture; take the size from the section, if any.
+        sprite->texture = NULL;
+        *w = in == NULL ? 0 : in->w;
+        *h = in == NULL ? 0 : in->h;
+    }
     sprite->scale = scale;
     sprite->frames = 0;
     sprite->speed = 0;
@@ -185,22 +206,26 @@ sprite_t *sprite_image(const char *image, double scale, SDL_Rect *in){
     return sprite;
 }
 
-sprite_t *sprite_animated(const char *image, double scale, int frames, int fps){
-    sprite_t *sprite = sprite_image(image, scale, NULL);
+sprite_t *sprite_animated(sdl_context_t *context, const char *image, double scale,
+                          int frames, int fps){
+    sprite_t *sprite = sprite_image(context, image, scale, NULL);
     *sprite->section = (SDL_Rect){0, 0, sprite->section->w / frames, sprite->section->h};
     sprite->frames = frames;
     sprite->speed = fps;
     return sprite;
 }
 
-sprite_t *sprite_scroll(const char *image, int scroll, SDL_Rect *in){
-    sprite_t *sprite = sprite_image(image, 1, in);
+sprite_t *sprite_scroll(sdl_context_t *context, const char *image, int scroll,
+                        SDL_Rect *in){
+    sprite_t *sprite = sprite_image(context, image, 1, in);
     sprite->speed = scroll;
     return sprite;
 }
 
 void sprite_free(sprite_t *sprite){
-    SDL_DestroyTexture(sprite->texture);
+    if (sprite->texture != NULL) {
+        SDL_DestroyTexture(sprite->texture);
+    }
     free(sprite->section);
     free(sprite);
 }
@@ -213,20 +238,34 @@ void sprite_set_dt(sprite_t *sprite, double dt){
     sprite->dt = dt;
 }
 
-SDL_Window *sdl_init(vector_t min, vector_t max) {
+sdl_context_t *sdl_init_headless(vector_t min, vector_t max) {
     // Check parameters
     assert(min.x < max.x);
     assert(min.y < max.y);
 
-    center = vec_multiply(0.5, vec_add(min, max));
-    max_diff = vec_subtract(max, center);
+    sdl_context_t *context = malloc(sizeof(sdl_context_t));
+    assert(context != NULL);
+    context->center = vec_multiply(0.5, vec_add(min, max));
+    context->max_diff = vec_subtract(max, context->center);
+    context->camera = VEC_ZERO;
+    context->window = NULL;
+    context->renderer = NULL;
+    context->key_handler = NULL;
+    context->mouse_handler = NULL;
+    context->key_start_timestamp = 0;
+    context->last_clock = 0;
+    return context;
+}
+
+sdl_context_t *sdl_init(vector_t min, vector_t max) {
+    sdl_context_t *context = sdl_init_headless(min, max);
     SDL_Init(SDL_INIT_EVERYTHING);
     if (!strcmp(SDL_GetPlatform(), "Mac OS X")) {
         SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl"); //For Mac optimization
     }
     TTF_Init();
     Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048);
-    window = SDL_CreateWindow(
+    context->window = SDL_CreateWindow(
         WINDOW_TITLE,
         SDL_WINDOWPOS_CENTERED,
         SDL_WINDOWPOS_CENTERED,
@@ -234,11 +273,28 @@ SDL_Window *sdl_init(vector_t min, vector_t max) {
         WINDOW_HEIGHT,
         SDL_WINDOW_RESIZABLE
     );
-    renderer = SDL_CreateRenderer(window, -1, 0);
-    return window;
+    context->renderer = SDL_CreateRenderer(context->window, -1, 0);
+    return context;
+}
+
+void sdl_free(sdl_context_t *context) {
+    if (context->renderer != NULL) {
+        SDL_DestroyRenderer(context->renderer);
+    }
+    if (context->window != NULL) {
+        SDL_DestroyWindow(context->window);
+    }
+    free(context);
+}
+
+bool sdl_is_headless(sdl_context_t *context) {
+    return context->window == NULL;
 }
 
-bool sdl_is_done(void *scene) {
+bool sdl_is_done(sdl_context_t *context, void *scene) {
+    if (sdl_is_headless(context)) {
+        return false;
+    }
     SDL_Event *event = malloc(sizeof(*event));
     assert(event != NULL);
     while (SDL_PollEvent(event)) {
@@ -256,28 +312,28 @@ bool sdl_is_done(void *scene) {
             case SDL_KEYUP:
                 // Skip the keypress if no handler is configured
                 // or an unrecognized key was pressed
-                if (key_handler == NULL) break;
+                if (context->key_handler == NULL) break;
                 char key = get_keycode(event->key.keysym.sym);
                 if (key == '\0') break;
 
                 uint32_t timestamp = event->key.timestamp;
                 if (!event->key.repeat) {
-                    key_start_timestamp = timestamp;
+                    context->key_start_timestamp = timestamp;
                 }
                 key_event_type_t type =
                     event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
-                double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
-                key_handler(key, (void *)type, held_time, scene);
+                double held_time = (timestamp - context->key_start_timestamp) / MS_PER_S;
+                context->key_handler(key, (void *)type, held_time, scene);
                 break;
             case SDL_MOUSEBUTTONDOWN:
             case SDL_MOUSEBUTTONUP:
-                if (mouse_handler == NULL) break;
+                if (context->mouse_handler == NULL) break;
                 char button = get_mousecode(event->button);
                 if (button == '\0') break;
                                 
                 mouse_event_type_t click =
                     event->type == SDL_MOUSEBUTTONUP ? BUTTON_PRESSED : BUTTON_RELEASED;
-                mouse_handler(button, (void *)click, 0, scene);
+                context->mouse_handler(button, (void *)click, 0, scene);
                 break;
         } 
     }
@@ -285,13 +341,16 @@ bool sdl_is_done(void *scene) {
     return false;
 }
 
-void sdl_clear(void) {
-    SDL_SetRenderDrawColor(renderer, (Uint8)BACKGROUND.r, (Uint8)BACKGROUND.g,
+void sdl_clear(sdl_context_t *context) {
+    if (sdl_is_headless(context)) {
+        return;
+    }
+    SDL_SetRenderDrawColor(context->renderer, (Uint8)BACKGROUND.r, (Uint8)BACKGROUND.g,
                            (Uint8)BACKGROUND.b, 255);
-    SDL_RenderClear(renderer);
+    SDL_RenderClear(context->renderer);
 }
 
-void sdl_draw_polygon(body_t *body, rgb_color_t *color) {
+void sdl_draw_polygon(body_t *body, rgb_color_t *color, sdl_context_t *context) {
     // Check parameters
     list_t *points = body_get_shape(body);
     int n = (int)list_size(points);
@@ -300,7 +359,7 @@ void sdl_draw_polygon(body_t *body, rgb_color_t *color) {
     assert(0 <= (*color).g && color->g <= 1);
     assert(0 <= (*color).b && color->b <= 1);
 
-    vector_t window_center = get_window_center();
+    vector_t window_center = get_window_center(context);
 
     // Convert each vertex to a point on screen
     int16_t *x_points = malloc(sizeof(*x_points) * n),
@@ -309,14 +368,14 @@ void sdl_draw_polygon(body_t *body, rgb_color_t *color) {
     assert(y_points != NULL);
     for (size_t i = 0; i < n; i++) {
         vector_t *vertex = list_get(points, i);
-        vector_t pixel = get_window_position(*vertex, window_center);
+        vector_t pixel = get_body_window_position(context, *vertex, window_center);
         x_points[i] = (int16_t)pixel.x;
         y_points[i] = (int16_t)pixel.y;
     }
 
     // Draw polygon with the given color
     filledPolygonRGBA(
-        renderer,
+        context->renderer,
         x_points, y_points, n,
         (Uint8)((*color).r*255), (Uint8)((*color).g*255), (Uint8)((*color).b*255), 255
     );
@@ -324,22 +383,24 @@ void sdl_draw_polygon(body_t *body, rgb_color_t *color) {
     free(y_points);
 }
 
-void sdl_draw_image(body_t *body, sprite_t *sprite) {
-    vector_t window_center = get_window_center();
-    vector_t center = get_window_position(body_get_centroid(body), window_center);
+void sdl_draw_image(body_t *body, sprite_t *sprite, sdl_context_t *context) {
+    vector_t window_center = get_window_center(context);
+    vector_t center = get_body_window_position(context, body_get_centroid(body),
+                                               window_center);
     SDL_Rect *out = malloc(sizeof(SDL_Rect));
     *out = (SDL_Rect) {(int)(center.x - sprite->scale * sprite->section->w/2),
                        (int)(center.y - sprite->scale * sprite->section->h/2), 
                        (int)(sprite->scale * sprite->section->w), 
                        (int)(sprite->scale * sprite->section->w)};
-    SDL_RenderCopy(renderer, sprite->texture, sprite->section, out);
+    SDL_RenderCopy(context->renderer, sprite->texture, sprite->section, out);
     free(out);
 }
 
-void sdl_draw_animated(body_t *body, sprite_t *sprite){
+void sdl_draw_animated(body_t *body, sprite_t *sprite, sdl_context_t *context){
     double time  = (double)clock() /CLOCKS_PER_SEC;
-    vector_t window_center = get_window_center();
-    vector_t center = get_window_position(body_get_centroid(body), window_center);
+    vector_t window_center = get_window_center(context);
+    vector_t center = get_body_window_position(context, body_get_centroid(body),
+                                               window_center);
     int frame = (int)(time * sprite->speed) % sprite->frames;
     assert((frame < sprite->frames) && (frame >= 0));
     int width = sprite->section->w;
@@ -349,11 +410,11 @@ void sdl_draw_animated(body_t *body, sprite_t *sprite){
                        (int)(center.y - (sprite->scale* sprite->section->h/2)), 
                        (int)(sprite->scale * width), 
                        (int)(sprite->scale * sprite->section->h)};
-    SDL_RenderCopy(renderer, sprite->texture, sprite->section, out);
+    SDL_RenderCopy(context->renderer, sprite->texture, sprite->section, out);
     free(out);
 }
 
-void sdl_draw_scroll(body_t *body, sprite_t *sprite){
+void sdl_draw_scroll(body_t *body, sprite_t *sprite, sdl_context_t *context){
     double time  = (double)clock() /CLOCKS_PER_SEC;
     if(sprite->dt == 0){
         sprite->clock = time;
@@ -375,76 +436,87 @@ void sdl_draw_scroll(body_t *body, sprite_t *sprite){
     sprite->frames = frame;
     SDL_Rect *in = malloc(sizeof(SDL_Rect));
     *in = (SDL_Rect) {frame, 0, width, sprite->section->h};   
-    SDL_RenderCopy(renderer, sprite->texture, in, NULL);
+    SDL_RenderCopy(context->renderer, sprite->texture, in, NULL);
 }
 
-void sdl_show(void) {
+void sdl_show(sdl_context_t *context) {
+    if (sdl_is_headless(context)) {
+        return;
+    }
     // Draw boundary lines
-    vector_t window_center = get_window_center();
-    vector_t max = vec_add(center, max_diff),
-             min = vec_subtract(center, max_diff);
-    vector_t max_pixel = get_window_position(max, window_center),
-             min_pixel = get_window_position(min, window_center);
+    vector_t window_center = get_window_center(context);
+    vector_t max = vec_add(context->center, context->max_diff),
+             min = vec_subtract(context->center, context->max_diff);
+    vector_t max_pixel = get_window_position(context, max, window_center),
+             min_pixel = get_window_position(context, min, window_center);
     SDL_Rect *boundary = malloc(sizeof(*boundary));
     boundary->x = (int)(min_pixel.x);
     boundary->y = (int)(max_pixel.y);
     boundary->w = (int)(max_pixel.x - min_pixel.x);
     boundary->h = (int)(min_pixel.y - max_pixel.y);
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderDrawRect(renderer, boundary);
+    SDL_SetRenderDrawColor(context->renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(context->renderer, boundary);
     free(boundary);
-    SDL_RenderPresent(renderer);
+    SDL_RenderPresent(context->renderer);
 }
 
-void sdl_render_scene(scene_t *scene) {
-    sdl_clear();
+void sdl_render_scene(sdl_context_t *context, scene_t *scene) {
+    if (sdl_is_headless(context)) {
+        return;
+    }
+    sdl_clear(context);
+    context->camera = scene_get_camera(scene);
     size_t bodies = scene_bodies(scene);
     for (size_t i = 0; i < bodies; i++) {
         body_t *body = scene_get_body(scene, i);
-        body_draw(body);
+        body_draw(body, context);
     }
-    sdl_show();
+    sdl_show(context);
 }
 
-void sdl_render_scene_with_score(scene_t *scene, text_info_t *score_text,
-    text_info_t *coins_text, text_info_t *powerup_text) {
-    sdl_clear();
+void sdl_render_scene_with_score(sdl_context_t *context, scene_t *scene,
+    text_info_t *score_text, text_info_t *coins_text, text_info_t *powerup_text) {
+    if (sdl_is_headless(context)) {
+        return;
+    }
+    sdl_clear(context);
+    context->camera = scene_get_camera(scene);
     size_t bodies = scene_bodies(scene);
     for (size_t i = 0; i < bodies; i++) {
         body_t *body = scene_get_body(scene, i);
-        body_draw(body);
+        body_draw(body, context);
     }
-    sdl_draw_text(NULL, score_text);
-    sdl_draw_text(NULL, coins_text);
-    sdl_draw_text(NULL, powerup_text);
-    sdl_show();
+    sdl_draw_text(NULL, score_text, context);
+    sdl_draw_text(NULL, coins_text, context);
+    sdl_draw_text(NULL, powerup_text, context);
+    sdl_show(context);
 }
 
-void sdl_on_key(event_handler_t handler) {
-    key_handler = handler;
+void sdl_on_key(sdl_context_t *context, event_handler_t handler) {
+    context->key_handler = handler;
 }
 
-void sdl_on_click(event_handler_t handler) {
-    mouse_handler = handler;
+void sdl_on_click(sdl_context_t *context, event_handler_t handler) {
+    context->mouse_handler = handler;
 }
 
-vector_t sdl_mouse_pos(){
-    vector_t window_center = get_window_center();
+vector_t sdl_mouse_pos(sdl_context_t *context){
+    vector_t window_center = get_window_center(context);
     int *mouse_x = malloc(sizeof(int));
     int *mouse_y = malloc(sizeof(int));
     SDL_GetMouseState(mouse_x, mouse_y);
     vector_t mouse = (vector_t){*mouse_x, *mouse_y};
     free(mouse_x);
     free(mouse_y);
-    return get_window_position(mouse, window_center);
+    return get_window_position(context, mouse, window_center);
 }
 
-double time_since_last_tick(void) {
+double time_since_last_tick(sdl_context_t *context) {
     clock_t now = clock();
-    double difference = last_clock
-        ? (double) (now - last_clock) / CLOCKS_PER_SEC
+    double difference = context->last_clock
+        ? (double) (now - context->last_clock) / CLOCKS_PER_SEC
         : 0.0; // return 0 the first time this is called
-    last_clock = now;
+    context->last_clock = now;
     return difference;
 }
 
@@ -468,20 +540,21 @@ text_info_t *outlined_text_info_init(char *text, const char *font,
     return info;
 }
 
-void sdl_draw_text(body_t *body, text_info_t *info) {
+void sdl_draw_text(body_t *body, text_info_t *info, sdl_context_t *context) {
     TTF_Font *ttf_font = TTF_OpenFont(info->font, info->size);
 
     SDL_Color sdl_color = {(Uint8)(info->color.r*255), (Uint8)(info->color.g*255),
                            (Uint8)(info->color.b*255)};
     SDL_Surface *text_surface = TTF_RenderText_Solid(ttf_font, info->text, sdl_color);
-    SDL_Texture *text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
+    SDL_Texture *text_texture = SDL_CreateTextureFromSurface(context->renderer,
+                                                             text_surface);
 
     int *width = malloc(sizeof(int));
     int *height = malloc(sizeof(int));
     TTF_SizeText(ttf_font, info->text, width, height);
     SDL_Rect *text_rect = malloc(sizeof(SDL_Rect));
     *text_rect = (SDL_Rect){(int)info->coords.x, (int)info->coords.y, *width, *height};
-    SDL_RenderCopy(renderer, text_texture, NULL, text_rect);
+    SDL_RenderCopy(context->renderer, text_texture, NULL, text_rect);
 
     SDL_FreeSurface(text_surface);
     SDL_DestroyTexture(text_texture);
@@ -491,17 +564,17 @@ void sdl_draw_text(body_t *body, text_info_t *info) {
     TTF_CloseFont(ttf_font);
 }
 
-void sdl_draw_outlined_text(body_t *body, text_info_t *info) {
+void sdl_draw_outlined_text(body_t *body, text_info_t *info, sdl_context_t *context) {
     sdl_draw_text(body, text_info_init(info->text, info->font, info->outline_color,
-        info->size, (vector_t){info->coords.x-info->thickness, info->coords.y}));
+        info->size, (vector_t){info->coords.x-info->thickness, info->coords.y}), context);
     sdl_draw_text(body, text_info_init(info->text, info->font, info->outline_color,
-        info->size, (vector_t){info->coords.x+info->thickness, info->coords.y}));
+        info->size, (vector_t){info->coords.x+info->thickness, info->coords.y}), context);
     sdl_draw_text(body, text_info_init(info->text, info->font, info->outline_color,
-        info->size, (vector_t){info->coords.x, info->coords.y-info->thickness}));
+        info->size, (vector_t){info->coords.x, info->coords.y-info->thickness}), context);
     sdl_draw_text(body, text_info_init(info->text, info->font, info->outline_color,
-        info->size, (vector_t){info->coords.x, info->coords.y+info->thickness}));
+        info->size, (vector_t){info->coords.x, info->coords.y+info->thickness}), context);
     sdl_draw_text(body, text_info_init(info->text, info->font, info->color,
-        info->size, (vector_t){info->coords.x, info->coords.y}));
+        info->size, (vector_t){info->coords.x, info->coords.y}), context);
 }
 
 int sdl_text_width(char *text, const char *font, int size) {
@@ -0,0 +1,236 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include "solver.h"
+#include "collision.h"
+
+//Number of passes over the contacts of a mover each tick.
+const size_t SOLVER_ITERATIONS = 8;
+//Overlap left in place, so resting contacts keep touching from tick to tick.
+const double PENETRATION_SLOP = 0.5;
+//Fraction of the overlap beyond the slop that is removed each tick.
+const double POSITION_CORRECTION = 0.8;
+//A contact normal whose y component is at least this much counts as ground.
+const double GROUND_NORMAL_Y = 0.7;
+//How much deeper than its fall in the last tick a mover may have sunk into
+//a one-way solid and still land on it.
+const double ONE_WAY_TOLERANCE = 1;
+
+const component_kind_t SOLID = {
+    .name = "solid",
+    .size = sizeof(solid_t)
+};
+
+const component_kind_t MOVER = {
+    .name = "mover",
+    .size = sizeof(mover_t)
+};
+
+void solver_add_solid(scene_t *scene, body_t *body, bool one_way) {
+    solid_t *solid = scene_add_component(scene, body, &SOLID);
+    solid->one_way = one_way;
+}
+
+void solver_add_terrain(scene_t *scene, body_t *body, bool one_way) {
+    terrain_add(scene_get_terrain(scene), body, one_way);
+}
+
+void solver_add_mover(scene_t *scene, body_t *body) {
+    mover_t *mover = scene_add_component(scene, body, &MOVER);
+    mover->grounded = false;
+    //An empty box, so the first search covers only where the mover is.
+    mover->terrain_box = (aabb_t) {{INFINITY, INFINITY}, {-INFINITY, -INFINITY}};
+}
+
+bool solver_is_grounded(scene_t *scene, body_t *body) {
+    mover_t *mover = scene_get_component(scene, body, &MOVER);
+    return mover != NULL && mover->grounded;
+}
+
+//A contact between a mover and a solid, gathered before solving.
+typedef struct {
+    body_t *solid;
+    //Unit vector pointing out of the solid towards the mover.
+    vector_t normal;
+    manifold_t manifold;
+    //The pair's state in the pair cache, found once every pair is recorded.
+    contact_t *contact;
+} solver_contact_t;
+
+double manifold_depth(manifold_t *manifold) {
+    double depth = 0;
+    for (size_t i = 0; i < manifold->count; i++) {
+        depth = fmax(depth, manifold->depths[i]);
+    }
+    return depth;
+}
+
+//Whether a mover overlapping a one-way solid came down onto its top,
+//rather than up or sideways through it. Once landed, it stays on the top.
+bool lands_on(body_t *mover, body_t *solid, vector_t normal, manifold_t *manifold,
+              contact_t *last, double dt) {
+    if (normal.y < GROUND_NORMAL_Y) {
+        return false;
+    }
+    if (last != NULL && last->touching) {
+        return true;
+    }
+    vector_t relative = vec_subtract(body_get_velocity(mover), body_get_velocity(solid));
+    double fallen = fmax(-vec_dot(relative, normal), 0) * dt;
+    return manifold_depth(manifold) <= fallen + ONE_WAY_TOLERANCE;
+}
+
+//Counts of the narrowphase work done for one mover.
+typedef struct {
+    size_t tests;
+    size_t axes;
+    size_t hits;
+} narrowphase_count_t;
+
+//Tests a mover against a solid, records the pair in the pair cache,
+//and adds a contact if they are touching.
+void test_solid(pair_cache_t *cache, body_t *mover, body_t *solid, bool one_way, bool near,
+                solver_contact_t *contacts, size_t *count, narrowphase_count_t *work,
+                double dt) {
+    collision_info_t collision = {false, VEC_ZERO, 0, 0};
+    if (near) {
+        contact_t *last = pair_cache_get(cache, mover, solid);
+        collision = find_body_collision(mover, solid,
+                                        last != NULL ? last->separating_axis : VEC_ZERO);
+        work->tests++;
+        work->axes += collision.axes_tested;
+        work->hits += collision.hint_separated;
+        if (collision.collided) {
+            vector_t normal = vec_negate(collision.axis);
+            manifold_t manifold = find_body_manifold(mover, solid, collision.axis);
+            bool landed = !one_way || lands_on(mover, solid, normal, &manifold, last, dt);
+            if (manifold.count > 0 && landed) {
+                contacts[(*count)++] = (solver_contact_t) {solid, normal, manifold, NULL};
+            } else {
+                //Passing through a one-way solid is not touching it.
+                collision = (collision_info_t) {false, VEC_ZERO, 0, collision.axes_tested};
+            }
+        }
+    }
+    pair_cache_update(cache, mover, solid, near, collision);
+}
+
+//Tests a mover against every solid and the terrain around it, records the pairs
+//in the pair cache, and returns how many of them are touching.
+size_t find_contacts(scene_t *scene, body_t *mover, mover_t *data, component_pool_t *solids,
+                     const terrain_span_t **spans, solver_contact_t *contacts, double dt) {
+    pair_cache_t *cache = scene_get_pair_cache(scene);
+    body_t **bodies = component_pool_bodies(solids);
+    solid_t *solid_data = component_pool_data(solids);
+    aabb_t box = body_get_aabb(mover);
+    size_t count = 0;
+    narrowphase_count_t work = {0, 0, 0};
+    for (size_t i = 0; i < component_pool_size(solids); i++) {
+        bool near = aabb_overlaps(box, body_get_aabb(bodies[i]));
+        test_solid(cache, mover, bodies[i], solid_data[i].one_way, near, contacts, &count,
+                   &work, dt);
+    }
+    //Search where the mover was last tick too, to drop the spans it has left.
+    terrain_t *terrain = scene_get_terrain(scene);
+    aabb_t local = terrain_local_box(terrain, box);
+    aabb_t last = data->terrain_box;
+    aabb_t search = {{fmin(local.min.x, last.min.x), fmin(local.min.y, last.min.y)},
+                     {fmax(local.max.x, last.max.x), fmax(local.max.y, last.max.y)}};
+    size_t num_spans = terrain_find(terrain, search, spans, terrain_size(terrain));
+    for (size_t i = 0; i < num_spans; i++) {
+        bool near = aabb_overlaps(local, spans[i]->box);
+        test_solid(cache, mover, spans[i]->body, spans[i]->one_way, near, contacts, &count,
+                   &work, dt);
+    }
+    data->terrain_box = local;
+    scene_count_narrowphase(scene, work.tests, work.axes, work.hits, 0);
+    return count;
+}
+
+//Applies sequential impulses to a mover until it is not moving into any solid.
+void solve_velocity(body_t *mover, solver_contact_t *contacts, size_t count, double dt) {
+    double mass = body_get_mass(mover);
+    vector_t predicted = body_predict_velocity(mover, dt);
+    vector_t velocity = predicted;
+    //Warm start from the impulses that held the contacts last tick.
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < contacts[i].manifold.count; j++) {
+            double impulse = contacts[i].contact->impulses[j];
+            velocity = vec_add(velocity, vec_multiply(impulse / mass, contacts[i].normal));
+        }
+    }
+    for (size_t iteration = 0; iteration < SOLVER_ITERATIONS; iteration++) {
+        for (size_t i = 0; i < count; i++) {
+            solver_contact_t *contact = &contacts[i];
+            vector_t solid_velocity = body_get_velocity(contact->solid);
+            for (size_t j = 0; j < contact->manifold.count; j++) {
+                double approach = vec_dot(vec_subtract(velocity, solid_velocity),
+                                          contact->normal);
+                //The accumulated impulse may shrink, but can never pull.
+                double *total = &contact->contact->impulses[j];
+                double impulse = fmax(*total - approach * mass, 0) - *total;
+                *total += impulse;
+                velocity = vec_add(velocity, vec_multiply(impulse / mass, contact->normal));
+            }
+        }
+    }
+    body_add_impulse(mover, vec_multiply(mass, vec_subtract(velocity, predicted)));
+}
+
+//Moves a mover out of the solids it overlaps, leaving the slop.
+//Bodies move at the average of their old and new velocities (see body_tick()),
+//so a mover that the contacts stopped will still sink by half its old speed;
+//it is pushed out by that much in advance.
+//Solids that share a normal (e.g. neighbouring blocks of floor) share the push.
+void solve_position(body_t *mover, solver_contact_t *contacts, size_t count, double dt) {
+    vector_t push = VEC_ZERO;
+    for (size_t i = 0; i < count; i++) {
+        solver_contact_t *contact = &contacts[i];
+        vector_t relative = vec_subtract(body_get_velocity(mover),
+                                         body_get_velocity(contact->solid));
+        double sink = fmax(-vec_dot(relative, contact->normal), 0) * dt / 2;
+        double depth = manifold_depth(&contact->manifold);
+        double target = fmax(depth - PENETRATION_SLOP, 0) * POSITION_CORRECTION + sink;
+        double needed = target - vec_dot(push, contact->normal);
+        if (needed > 0) {
+            push = vec_add(push, vec_multiply(needed, contact->normal));
+        }
+    }
+    body_translate(mover, push);
+}
+
+void solver_step(scene_t *scene, double dt) {
+    component_pool_t *movers = scene_get_components(scene, &MOVER);
+    component_pool_t *solids = scene_get_components(scene, &SOLID);
+    if (component_pool_size(movers) == 0) {
+        return;
+    }
+    pair_cache_t *cache = scene_get_pair_cache(scene);
+    size_t num_spans = terrain_size(scene_get_terrain(scene));
+    solver_contact_t *contacts = malloc(sizeof(solver_contact_t) *
+                                        (component_pool_size(solids) + num_spans + 1));
+    const terrain_span_t **spans = malloc(sizeof(terrain_span_t *) * (num_spans + 1));
+    assert(contacts != NULL && spans != NULL);
+    body_t **bodies = component_pool_bodies(movers);
+    mover_t *data = component_pool_data(movers);
+    for (size_t i = 0; i < component_pool_size(movers); i++) {
+        body_t *mover = bodies[i];
+        size_t count = find_contacts(scene, mover, &data[i], solids, spans, contacts, dt);
+        //Every pair is recorded, so the cache will not move until the next mover.
+        data[i].grounded = false;
+        for (size_t j = 0; j < count; j++) {
+            contacts[j].contact = pair_cache_get(cache, mover, contacts[j].solid);
+            contacts[j].contact->manifold = contacts[j].manifold;
+            for (size_t k = contacts[j].manifold.count; k < MAX_MANIFOLD_POINTS; k++) {
+                contacts[j].contact->impulses[k] = 0;
+            }
+            if (contacts[j].normal.y >= GROUND_NORMAL_Y) {
+                data[i].grounded = true;
+            }
+        }
+        solve_velocity(mover, contacts, count, dt);
+        solve_position(mover, contacts, count, dt);
+    }
+    free(contacts);
+    free(spans);
+}
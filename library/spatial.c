@@ -0,0 +1,333 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include "spatial.h"
+#include "scene.h"
+
+const size_t DEFAULT_SPATIAL_CAPACITY = 16;
+const size_t SPATIAL_RESIZE_FACTOR = 2;
+//A node with this many bodies or fewer is not split any further.
+const size_t SPATIAL_LEAF_SIZE = 4;
+//Nodes are split at the median, so the tree is never deeper than this.
+#define SPATIAL_MAX_DEPTH 64
+//Marks a body that has no item in items_of.
+const size_t NO_ITEM = SIZE_MAX;
+
+//A body's bounding box and type mask, copied when the index is built.
+typedef struct {
+    aabb_t box;
+    uint64_t types;
+    body_t *body;
+    //Where the body was in the array the index was built over.
+    size_t source;
+} spatial_item_t;
+
+typedef struct {
+    aabb_t box;
+    //The union of the type masks of the node's bodies.
+    uint64_t types;
+    //The node's bodies are items[first] to items[first + count - 1].
+    size_t first;
+    size_t count;
+    bool leaf;
+    //Indices of the two halves. The root is node 0, so it is never a child.
+    size_t children[2];
+} spatial_node_t;
+
+typedef struct spatial_index {
+    spatial_item_t *items;
+    size_t num_items;
+    size_t items_capacity;
+    spatial_node_t *nodes;
+    size_t num_nodes;
+    size_t nodes_capacity;
+    //The item made from each body of the array the index was built over,
+    //or NO_ITEM for removed bodies, so a refit can read the bodies in order.
+    size_t *items_of;
+    size_t num_sources;
+    size_t sources_capacity;
+} spatial_index_t;
+
+spatial_index_t *spatial_index_init(void) {
+    spatial_index_t *index = malloc(sizeof(spatial_index_t));
+    assert(index != NULL);
+    index->items_capacity = DEFAULT_SPATIAL_CAPACITY;
+    index->items = malloc(sizeof(spatial_item_t) * index->items_capacity);
+    index->nodes_capacity = DEFAULT_SPATIAL_CAPACITY;
+    index->nodes = malloc(sizeof(spatial_node_t) * index->nodes_capacity);
+    index->sources_capacity = DEFAULT_SPATIAL_CAPACITY;
+    index->items_of = malloc(sizeof(size_t) * index->sources_capacity);
+    assert(index->items != NULL && index->nodes != NULL && index->items_of != NULL);
+    index->num_items = 0;
+    index->num_nodes = 0;
+    index->num_sources = 0;
+    return index;
+}
+
+void spatial_index_free(spatial_index_t *index) {
+    free(index->items);
+    free(index->nodes);
+    free(index->items_of);
+    free(index);
+}
+
+//Gets the bit of a body's type in a type mask. Types past 63 only match ALL_TYPES.
+uint64_t type_bit(body_t *body) {
+    size_t type = body_get_type(body);
+    return type < 64 ? (uint64_t) 1 << type : 0;
+}
+
+bool types_match(uint64_t types, uint64_t mask) {
+    return types == ALL_TYPES || (types & mask) != 0;
+}
+
+double item_center(spatial_item_t *item, bool by_x) {
+    return by_x ? item->box.min.x + item->box.max.x : item->box.min.y + item->box.max.y;
+}
+
+//Reorders items so the one with the kth smallest center is at k,
+//with no larger centers before it and no smaller ones after (Hoare's find).
+void select_median(spatial_item_t *items, size_t count, size_t k, bool by_x) {
+    long low = 0;
+    long high = (long) count - 1;
+    long target = (long) k;
+    while (low < high) {
+        double pivot = item_center(&items[target], by_x);
+        long i = low;
+        long j = high;
+        while (i <= j) {
+            while (item_center(&items[i], by_x) < pivot) {
+                i++;
+            }
+            while (pivot < item_center(&items[j], by_x)) {
+                j--;
+            }
+            if (i <= j) {
+                spatial_item_t temp = items[i];
+                items[i] = items[j];
+                items[j] = temp;
+                i++;
+                j--;
+            }
+        }
+        if (j < target) {
+            low = i;
+        }
+        if (target < i) {
+            high = j;
+        }
+    }
+}
+
+//Adds the node for a range of items and, unless it is small enough to be
+//a leaf, its two halves, split at the median along the longer side.
+size_t spatial_build(spatial_index_t *index, size_t first, size_t count) {
+    if (index->num_nodes == index->nodes_capacity) {
+        index->nodes_capacity *= SPATIAL_RESIZE_FACTOR;
+        index->nodes = realloc(index->nodes, sizeof(spatial_node_t) * index->nodes_capacity);
+        assert(index->nodes != NULL);
+    }
+    size_t node_index = index->num_nodes++;
+    spatial_node_t node = {{{INFINITY, INFINITY}, {-INFINITY, -INFINITY}}, 0,
+                           first, count, true, {0}};
+    for (size_t i = first; i < first + count; i++) {
+        aabb_t box = index->items[i].box;
+        node.box.min.x = fmin(node.box.min.x, box.min.x);
+        node.box.min.y = fmin(node.box.min.y, box.min.y);
+        node.box.max.x = fmax(node.box.max.x, box.max.x);
+        node.box.max.y = fmax(node.box.max.y, box.max.y);
+        node.types |= index->items[i].types;
+    }
+    if (count > SPATIAL_LEAF_SIZE) {
+        node.leaf = false;
+        bool by_x = node.box.max.x - node.box.min.x >= node.box.max.y - node.box.min.y;
+        size_t half = count / 2;
+        select_median(&index->items[first], count, half, by_x);
+        node.children[0] = spatial_build(index, first, half);
+        node.children[1] = spatial_build(index, first + half, count - half);
+    }
+    //Building the children may have moved the nodes.
+    index->nodes[node_index] = node;
+    return node_index;
+}
+
+void spatial_index_build(spatial_index_t *index, body_t **bodies, size_t count) {
+    if (count > index->items_capacity) {
+        index->items_capacity = count;
+        index->items = realloc(index->items, sizeof(spatial_item_t) * index->items_capacity);
+        assert(index->items != NULL);
+    }
+    if (count > index->sources_capacity) {
+        index->sources_capacity = count;
+        index->items_of = realloc(index->items_of, sizeof(size_t) * index->sources_capacity);
+        assert(index->items_of != NULL);
+    }
+    index->num_items = 0;
+    for (size_t i = 0; i < count; i++) {
+        index->items_of[i] = NO_ITEM;
+        if (!body_is_removed(bodies[i])) {
+            index->items[index->num_items++] = (spatial_item_t) {
+                body_get_aabb(bodies[i]), type_bit(bodies[i]), bodies[i], i};
+        }
+    }
+    index->num_sources = count;
+    index->num_nodes = 0;
+    if (index->num_items > 0) {
+        spatial_build(index, 0, index->num_items);
+    }
+    for (size_t i = 0; i < index->num_items; i++) {
+        index->items_of[index->items[i].source] = i;
+    }
+}
+
+void spatial_index_refit(spatial_index_t *index, body_t **bodies, size_t count) {
+    assert(count == index->num_sources);
+    //Reading the bodies in the order they were given is much faster than
+    //in the order of the tree, which jumps all over memory.
+    for (size_t i = 0; i < count; i++) {
+        if (index->items_of[i] != NO_ITEM) {
+            assert(index->items[index->items_of[i]].body == bodies[i]);
+            index->items[index->items_of[i]].box = body_get_aabb(bodies[i]);
+        }
+    }
+    //Children come after their parents, so going backwards refits them first.
+    for (size_t i = index->num_nodes; i-- > 0;) {
+        spatial_node_t *node = &index->nodes[i];
+        aabb_t box = {{INFINITY, INFINITY}, {-INFINITY, -INFINITY}};
+        size_t num_boxes = node->leaf ? node->count : 2;
+        for (size_t j = 0; j < num_boxes; j++) {
+            aabb_t child = node->leaf ? index->items[node->first + j].box
+                                      : index->nodes[node->children[j]].box;
+            box.min.x = fmin(box.min.x, child.min.x);
+            box.min.y = fmin(box.min.y, child.min.y);
+            box.max.x = fmax(box.max.x, child.max.x);
+            box.max.y = fmax(box.max.y, child.max.y);
+        }
+        node->box = box;
+    }
+}
+
+//Visits the leaves of the index whose boxes overlap a box and hold bodies
+//of the given types, and writes the bodies that pass a test to out.
+//Every node visited either overlaps the box or is skipped with its subtree.
+size_t spatial_collect(spatial_index_t *index, aabb_t box, uint64_t types,
+                       bool (*test)(spatial_item_t *item, void *aux), void *aux,
+                       body_t **out, size_t capacity) {
+    size_t found = 0;
+    if (index->num_nodes == 0 || capacity == 0) {
+        return found;
+    }
+    size_t stack[SPATIAL_MAX_DEPTH + 1];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        spatial_node_t *node = &index->nodes[stack[--top]];
+        if (!aabb_overlaps(node->box, box) || !types_match(types, node->types)) {
+            continue;
+        }
+        if (!node->leaf) {
+            stack[top++] = node->children[1];
+            stack[top++] = node->children[0];
+            continue;
+        }
+        for (size_t i = node->first; i < node->first + node->count; i++) {
+            spatial_item_t *item = &index->items[i];
+            if (aabb_overlaps(item->box, box) && types_match(types, item->types) &&
+                    !body_is_removed(item->body) && test(item, aux)) {
+                out[found++] = item->body;
+                if (found == capacity) {
+                    return found;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+bool accept_any(spatial_item_t *item, void *aux) {
+    return true;
+}
+
+bool contains_point(spatial_item_t *item, void *point) {
+    return find_point_in_body(item->body, *(vector_t *) point);
+}
+
+size_t spatial_index_query_aabb(spatial_index_t *index, aabb_t box, uint64_t types,
+                                body_t **out, size_t capacity) {
+    return spatial_collect(index, box, types, accept_any, NULL, out, capacity);
+}
+
+size_t spatial_index_query_point(spatial_index_t *index, vector_t point, uint64_t types,
+                                 body_t **out, size_t capacity) {
+    aabb_t box = {point, point};
+    return spatial_collect(index, box, types, contains_point, &point, out, capacity);
+}
+
+//Finds how far along a ray (from 0 to 1) it enters a box,
+//or INFINITY if it misses the box.
+double ray_enters_box(vector_t start, vector_t direction, aabb_t box) {
+    double enter = 0;
+    double exit = 1;
+    double starts[2] = {start.x, start.y};
+    double directions[2] = {direction.x, direction.y};
+    double mins[2] = {box.min.x, box.min.y};
+    double maxes[2] = {box.max.x, box.max.y};
+    for (size_t axis = 0; axis < 2; axis++) {
+        if (directions[axis] == 0) {
+            if (starts[axis] < mins[axis] || starts[axis] > maxes[axis]) {
+                return INFINITY;
+            }
+            continue;
+        }
+        double t1 = (mins[axis] - starts[axis]) / directions[axis];
+        double t2 = (maxes[axis] - starts[axis]) / directions[axis];
+        enter = fmax(enter, fmin(t1, t2));
+        exit = fmin(exit, fmax(t1, t2));
+    }
+    return enter <= exit ? enter : INFINITY;
+}
+
+bool spatial_index_raycast(spatial_index_t *index, vector_t start, vector_t end,
+                           uint64_t types, ray_hit_t *hit) {
+    if (index->num_nodes == 0) {
+        return false;
+    }
+    vector_t direction = vec_subtract(end, start);
+    //Hits are at most 1 along the ray, and missed boxes are at INFINITY.
+    double best = 1;
+    bool found = false;
+    size_t stack[SPATIAL_MAX_DEPTH + 1];
+    size_t top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        spatial_node_t *node = &index->nodes[stack[--top]];
+        if (!types_match(types, node->types) ||
+                ray_enters_box(start, direction, node->box) > best) {
+            continue;
+        }
+        if (!node->leaf) {
+            //Visit the nearer half first, so it can rule out the farther one.
+            double near0 = ray_enters_box(start, direction,
+                                          index->nodes[node->children[0]].box);
+            double near1 = ray_enters_box(start, direction,
+                                          index->nodes[node->children[1]].box);
+            size_t nearer = near0 <= near1 ? 0 : 1;
+            stack[top++] = node->children[1 - nearer];
+            stack[top++] = node->children[nearer];
+            continue;
+        }
+        for (size_t i = node->first; i < node->first + node->count; i++) {
+            spatial_item_t *item = &index->items[i];
+            ray_hit_t item_hit;
+            if (types_match(types, item->types) && !body_is_removed(item->body) &&
+                    ray_enters_box(start, direction, item->box) <= best &&
+                    find_ray_hit(item->body, start, end, &item_hit) &&
+                    (!found || item_hit.fraction < best)) {
+                best = item_hit.fraction;
+                found = true;
+                *hit = item_hit;
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,236 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "terrain.h"
+
+const size_t DEFAULT_TERRAIN_CAPACITY = 16;
+const size_t DEFAULT_TERRAIN_COLUMNS = 64;
+const size_t DEFAULT_COLUMN_CAPACITY = 4;
+const size_t TERRAIN_RESIZE_FACTOR = 2;
+//Wide enough that a mover spans only a column or two.
+const double TERRAIN_COLUMN_WIDTH = 64;
+
+typedef struct terrain {
+    //The spans, packed so they can be walked and copied as one array.
+    terrain_span_t *spans;
+    size_t size;
+    size_t capacity;
+    //Ring of columns: column c is kept in slot c mod num_columns, which holds
+    //the indices of the spans crossing it in cells, column_capacity per slot.
+    //keys records which column a slot holds; a slot with no spans is free.
+    int64_t *keys;
+    size_t *counts;
+    size_t *cells;
+    size_t num_columns;
+    size_t column_capacity;
+    vector_t origin;
+} terrain_t;
+
+//Allocates the columns, all free.
+void terrain_alloc_columns(terrain_t *terrain) {
+    terrain->keys = malloc(sizeof(int64_t) * terrain->num_columns);
+    terrain->counts = calloc(terrain->num_columns, sizeof(size_t));
+    terrain->cells = malloc(sizeof(size_t) * terrain->num_columns * terrain->column_capacity);
+    assert(terrain->keys != NULL && terrain->counts != NULL && terrain->cells != NULL);
+}
+
+void terrain_free_columns(terrain_t *terrain) {
+    free(terrain->keys);
+    free(terrain->counts);
+    free(terrain->cells);
+}
+
+terrain_t *terrain_init(void) {
+    terrain_t *terrain = malloc(sizeof(terrain_t));
+    assert(terrain != NULL);
+    terrain->spans = malloc(sizeof(terrain_span_t) * DEFAULT_TERRAIN_CAPACITY);
+    assert(terrain->spans != NULL);
+    terrain->size = 0;
+    terrain->capacity = DEFAULT_TERRAIN_CAPACITY;
+    terrain->num_columns = DEFAULT_TERRAIN_COLUMNS;
+    terrain->column_capacity = DEFAULT_COLUMN_CAPACITY;
+    terrain_alloc_columns(terrain);
+    terrain->origin = VEC_ZERO;
+    return terrain;
+}
+
+void terrain_free(terrain_t *terrain) {
+    free(terrain->spans);
+    terrain_free_columns(terrain);
+    free(terrain);
+}
+
+size_t terrain_size(terrain_t *terrain) {
+    return terrain->size;
+}
+
+const terrain_span_t *terrain_spans(terrain_t *terrain) {
+    return terrain->spans;
+}
+
+vector_t terrain_get_origin(terrain_t *terrain) {
+    return terrain->origin;
+}
+
+aabb_t terrain_local_box(terrain_t *terrain, aabb_t box) {
+    return (aabb_t) {vec_add(box.min, terrain->origin), vec_add(box.max, terrain->origin)};
+}
+
+int64_t column_of(double x) {
+    return (int64_t) floor(x / TERRAIN_COLUMN_WIDTH);
+}
+
+size_t column_slot(terrain_t *terrain, int64_t column) {
+    int64_t slot = column % (int64_t) terrain->num_columns;
+    return (size_t) (slot < 0 ? slot + (int64_t) terrain->num_columns : slot);
+}
+
+//Adds a span to the columns from first to last. If a column is full, or its
+//slot holds another column that still has spans, grows whatever ran out
+//and returns false; the columns must then be laid out again.
+bool columns_insert_range(terrain_t *terrain, size_t index, int64_t first, int64_t last) {
+    for (int64_t column = first; column <= last; column++) {
+        size_t slot = column_slot(terrain, column);
+        if (terrain->counts[slot] > 0 && terrain->keys[slot] != column) {
+            terrain->num_columns *= TERRAIN_RESIZE_FACTOR;
+            return false;
+        }
+        if (terrain->counts[slot] == terrain->column_capacity) {
+            terrain->column_capacity *= TERRAIN_RESIZE_FACTOR;
+            return false;
+        }
+        terrain->keys[slot] = column;
+        terrain->cells[slot * terrain->column_capacity + terrain->counts[slot]++] = index;
+    }
+    return true;
+}
+
+//Adds a span to all the columns it crosses, as columns_insert_range() does.
+bool columns_insert(terrain_t *terrain, size_t index) {
+    aabb_t box = terrain->spans[index].box;
+    return columns_insert_range(terrain, index, column_of(box.min.x), column_of(box.max.x));
+}
+
+//Rebuilds the columns from the spans, growing them until every span fits.
+void columns_layout(terrain_t *terrain) {
+    bool fits = false;
+    while (!fits) {
+        terrain_free_columns(terrain);
+        terrain_alloc_columns(terrain);
+        fits = true;
+        for (size_t i = 0; i < terrain->size && fits; i++) {
+            fits = columns_insert(terrain, i);
+        }
+    }
+}
+
+void terrain_reserve(terrain_t *terrain, size_t capacity) {
+    if (capacity <= terrain->capacity) {
+        return;
+    }
+    terrain->capacity = capacity;
+    terrain->spans = realloc(terrain->spans, sizeof(terrain_span_t) * terrain->capacity);
+    assert(terrain->spans != NULL);
+}
+
+void terrain_add(terrain_t *terrain, body_t *body, bool one_way) {
+    assert(body_is_rect(body));
+    if (terrain->size == terrain->capacity) {
+        terrain_reserve(terrain, terrain->capacity * TERRAIN_RESIZE_FACTOR);
+    }
+    aabb_t box = terrain_local_box(terrain, body_get_aabb(body));
+    terrain->spans[terrain->size++] = (terrain_span_t) {body, box, one_way};
+    if (!columns_insert(terrain, terrain->size - 1)) {
+        columns_layout(terrain);
+    }
+}
+
+void terrain_update(terrain_t *terrain, const terrain_span_t *span) {
+    assert(span >= terrain->spans && span < terrain->spans + terrain->size);
+    size_t index = (size_t) (span - terrain->spans);
+    assert(body_is_rect(span->body));
+    aabb_t old = span->box;
+    aabb_t box = terrain_local_box(terrain, body_get_aabb(span->body));
+    terrain->spans[index].box = box;
+    int64_t old_first = column_of(old.min.x);
+    int64_t old_last = column_of(old.max.x);
+    int64_t first = column_of(box.min.x);
+    int64_t last = column_of(box.max.x);
+    //A span that only grew is added to the columns it gained; one that
+    //shrank or moved would have to be taken out of others, so lay them out again.
+    if (first > old_first || last < old_last ||
+            !columns_insert_range(terrain, index, first, old_first - 1) ||
+            !columns_insert_range(terrain, index, old_last + 1, last)) {
+        columns_layout(terrain);
+    }
+}
+
+size_t terrain_find(terrain_t *terrain, aabb_t box, const terrain_span_t **out,
+                    size_t capacity) {
+    size_t found = 0;
+    if (capacity == 0 || terrain->size == 0) {
+        return found;
+    }
+    int64_t first = column_of(box.min.x);
+    int64_t last = column_of(box.max.x);
+    //A box wider than the ring would visit slots more than once.
+    if (!(box.max.x - box.min.x < TERRAIN_COLUMN_WIDTH * (terrain->num_columns - 1))) {
+        for (size_t i = 0; i < terrain->size && found < capacity; i++) {
+            if (aabb_overlaps(terrain->spans[i].box, box)) {
+                out[found++] = &terrain->spans[i];
+            }
+        }
+        return found;
+    }
+    for (int64_t column = first; column <= last; column++) {
+        size_t slot = column_slot(terrain, column);
+        if (terrain->counts[slot] == 0 || terrain->keys[slot] != column) {
+            continue;
+        }
+        size_t *cells = &terrain->cells[slot * terrain->column_capacity];
+        for (size_t i = 0; i < terrain->counts[slot]; i++) {
+            terrain_span_t *span = &terrain->spans[cells[i]];
+            //A span crossing several of the columns is found in the first of them.
+            int64_t span_first = column_of(span->box.min.x);
+            if ((span_first == column || (span_first < first && column == first)) &&
+                    aabb_overlaps(span->box, box)) {
+                out[found++] = span;
+                if (found == capacity) {
+                    return found;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+void terrain_rebase(terrain_t *terrain, vector_t origin) {
+    terrain->origin = vec_add(terrain->origin, origin);
+}
+
+void terrain_filter(terrain_t *terrain, keep_func_t keep) {
+    size_t kept = 0;
+    for (size_t i = 0; i < terrain->size; i++) {
+        if (keep(terrain->spans[i].body)) {
+            terrain->spans[kept++] = terrain->spans[i];
+        }
+    }
+    if (kept == terrain->size) {
+        return;
+    }
+    terrain->size = kept;
+    columns_layout(terrain);
+}
+
+void terrain_set(terrain_t *terrain, const terrain_span_t *spans, size_t count,
+                 vector_t origin) {
+    terrain_reserve(terrain, count);
+    if (count > 0) {
+        memcpy(terrain->spans, spans, sizeof(terrain_span_t) * count);
+    }
+    terrain->size = count;
+    terrain->origin = origin;
+    columns_layout(terrain);
+}